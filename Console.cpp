@@ -0,0 +1,105 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "Console.h"
+
+#pragma region Private
+
+const ConsoleCommand* _commands = nullptr;
+byte _commandCount = 0;
+
+char _line[CONSOLE_LINE_LENGTH];
+byte _lineLength = 0;
+bool _overflowed = false;       // The current line did not fit, drop it at its end
+
+/// <summary>Split the line into words in place and run its command.</summary>
+void _run(Print& out)
+{
+    char* argv[CONSOLE_MAX_ARGS];
+    byte argc = 0;
+    char* word = strtok(_line, " \t");
+    while (word != nullptr && argc < CONSOLE_MAX_ARGS)
+    {
+        argv[argc++] = word;
+        word = strtok(nullptr, " \t");
+    }
+    if (argc == 0)
+        return;
+
+    if (strcmp(argv[0], "help") == 0)
+    {
+        Console.printHelp(out);
+        return;
+    }
+    for (byte i = 0; i < _commandCount; i++)
+    {
+        if (strcmp(argv[0], _commands[i].name) == 0)
+        {
+            _commands[i].handler(out, argc, argv);
+            return;
+        }
+    }
+    out.print("Unknown command: ");
+    out.println(argv[0]);
+}
+
+#pragma endregion
+
+
+#pragma region Public
+
+void ConsoleClass::init(const ConsoleCommand* commands, byte count)
+{
+    _commands = commands;
+    _commandCount = count;
+    _lineLength = 0;
+    _overflowed = false;
+}
+
+void ConsoleClass::update(Stream& port)
+{
+    while (port.available() > 0)
+    {
+        char c = port.read();
+        if (c == '\r' || c == '\n')
+        {
+            if (_overflowed)
+                port.println("Line too long");
+            else if (_lineLength > 0)
+            {
+                _line[_lineLength] = '\0';
+                _run(port);
+            }
+            _lineLength = 0;
+            _overflowed = false;
+        }
+        else if (_lineLength < CONSOLE_LINE_LENGTH - 1)
+        {
+            _line[_lineLength++] = c;
+        }
+        else
+        {
+            _overflowed = true;
+        }
+    }
+}
+
+void ConsoleClass::printHelp(Print& out)
+{
+    out.println("Commands:");
+    out.println("  help");
+    for (byte i = 0; i < _commandCount; i++)
+    {
+        out.print("  ");
+        out.println(_commands[i].usage);
+    }
+}
+
+#pragma endregion
+
+
+ConsoleClass Console;
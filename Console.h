@@ -0,0 +1,48 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Console.h
+// Line based diagnostics console. Bytes are taken as they arrive, nothing waits for input,
+// and a command runs once its line is complete.
+
+#ifndef _CONSOLE_h
+#define _CONSOLE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+// Longest command line, longer lines are thrown away
+#define CONSOLE_LINE_LENGTH 48
+// Words per line, the command name included
+#define CONSOLE_MAX_ARGS 4
+
+// Runs a command. argv[0] is the command name, replies go to out.
+typedef void (*ConsoleHandler)(Print& out, byte argc, char* argv[]);
+
+struct ConsoleCommand
+{
+    const char* name;
+    const char* usage;          // Shown by help, e.g. "led <first> [last]"
+    ConsoleHandler handler;
+};
+
+class ConsoleClass
+{
+public:
+
+	void init(const ConsoleCommand* commands, byte count);
+	// Take whatever has arrived on the port and run any complete line. Never waits.
+	void update(Stream& port);
+	void printHelp(Print& out);
+};
+
+extern ConsoleClass Console;
+
+#endif
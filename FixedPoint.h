@@ -0,0 +1,229 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// FixedPoint.h
+// Q16.16 fixed-point math. The SAM3X has no FPU, so every float operation is a library call;
+// these are plain integer instructions. Range is about +-32767 with 1/65536 resolution, and
+// every operation saturates instead of wrapping.
+
+#ifndef _FIXEDPOINT_h
+#define _FIXEDPOINT_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+typedef int32_t fix16_t;
+
+#define FIX16_ONE  ((fix16_t)0x00010000)
+#define FIX16_MAX  ((fix16_t)0x7FFFFFFF)
+#define FIX16_MIN  ((fix16_t)0x80000000)
+#define FIX16_HALF ((fix16_t)0x00008000)
+
+// Constant from a literal, folded at compile time: F16(0.02)
+#define F16(x) ((fix16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/// <summary>Clamp a 64-bit intermediate into range.</summary>
+inline fix16_t fix16_saturate(int64_t x)
+{
+    if (x > FIX16_MAX) return FIX16_MAX;
+    if (x < FIX16_MIN) return FIX16_MIN;
+    return (fix16_t)x;
+}
+
+inline fix16_t fix16_from_int(int32_t x)
+{
+    return fix16_saturate((int64_t)x << 16);
+}
+
+/// <summary>Whole part, truncated toward zero like a float to int cast.</summary>
+inline int32_t fix16_to_int(fix16_t x)
+{
+    return x >= 0 ? (x >> 16) : -((-(int64_t)x) >> 16);
+}
+
+/// <summary>Nearest whole number.</summary>
+inline int32_t fix16_round(fix16_t x)
+{
+    return x >= 0 ? ((int64_t)x + FIX16_HALF) >> 16 : -((-(int64_t)x + FIX16_HALF) >> 16);
+}
+
+/// <summary>Only for display, this is a float division.</summary>
+inline float fix16_to_float(fix16_t x)
+{
+    return (float)x / 65536.0f;
+}
+
+/// <summary>Convert a float (e.g. a Simpit payload field) by taking its IEEE-754 bits apart,
+/// no float math involved. Values out of range saturate, NaN becomes 0.</summary>
+inline fix16_t fix16_from_float_bits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    bool negative = bits >> 31;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0) return 0;                                    // Zero or denormal
+    if (exponent == 0xFF && mantissa != 0) return 0;                // NaN
+    mantissa |= 0x800000;
+
+    // value = mantissa * 2^(exponent - 150), fixed = value * 2^16
+    int32_t shift = exponent - 150 + 16;
+    uint32_t magnitude;
+    if (shift > 7) return negative ? FIX16_MIN : FIX16_MAX;         // Too big (or infinity)
+    else if (shift >= 0) magnitude = mantissa << shift;
+    else if (shift > -25) magnitude = (mantissa + (1UL << (-shift - 1))) >> -shift;
+    else return 0;                                                  // Too small
+
+    return negative ? -(fix16_t)magnitude : (fix16_t)magnitude;
+}
+
+/// <summary>Whole part of a float from its bits, saturating to int32. For values too big for Q16.16
+/// (distances). Truncates toward zero like a cast, or rounds to nearest.</summary>
+inline int32_t int_from_float_bits(float f, bool roundNearest = false)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    bool negative = bits >> 31;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF && mantissa != 0) return 0;                // NaN
+    if (exponent < (roundNearest ? 126 : 127)) return 0;            // Rounds or truncates to 0
+    mantissa |= 0x800000;
+
+    int32_t shift = exponent - 150;
+    uint32_t magnitude;
+    if (shift > 7) return negative ? INT32_MIN : INT32_MAX;
+    else if (shift >= 0) magnitude = mantissa << shift;
+    else magnitude = (mantissa + (roundNearest ? 1UL << (-shift - 1) : 0)) >> -shift;
+
+    if (!negative && magnitude > (uint32_t)INT32_MAX) return INT32_MAX;
+    return negative ? -(int32_t)magnitude : (int32_t)magnitude;
+}
+
+inline fix16_t fix16_add(fix16_t a, fix16_t b)
+{
+    return fix16_saturate((int64_t)a + b);
+}
+
+inline fix16_t fix16_sub(fix16_t a, fix16_t b)
+{
+    return fix16_saturate((int64_t)a - b);
+}
+
+inline fix16_t fix16_mul(fix16_t a, fix16_t b)
+{
+    int64_t product = (int64_t)a * b;
+    // Round half away from zero
+    product += product >= 0 ? FIX16_HALF : -FIX16_HALF;
+    return fix16_saturate(product / FIX16_ONE);
+}
+
+inline fix16_t fix16_div(fix16_t a, fix16_t b)
+{
+    if (b == 0) return a >= 0 ? FIX16_MAX : FIX16_MIN;
+    return fix16_saturate(((int64_t)a << 16) / b);
+}
+
+/// <summary>Integer times a Q16.16 factor, e.g. a unit conversion of a large count. Rounds to nearest.</summary>
+inline int32_t fix16_scale_int(int32_t value, fix16_t factor)
+{
+    int64_t product = (int64_t)value * factor;
+    product += product >= 0 ? FIX16_HALF : -FIX16_HALF;
+    product /= FIX16_ONE;
+    if (product > INT32_MAX) return INT32_MAX;
+    if (product < INT32_MIN) return INT32_MIN;
+    return (int32_t)product;
+}
+
+inline fix16_t fix16_abs(fix16_t x)
+{
+    if (x == FIX16_MIN) return FIX16_MAX;
+    return x < 0 ? -x : x;
+}
+
+inline fix16_t fix16_clamp(fix16_t x, fix16_t low, fix16_t high)
+{
+    if (x < low) return low;
+    if (x > high) return high;
+    return x;
+}
+
+/// <summary>a + (b - a) * t</summary>
+inline fix16_t fix16_lerp(fix16_t a, fix16_t b, fix16_t t)
+{
+    return fix16_add(a, fix16_mul(fix16_sub(b, a), t));
+}
+
+/// <summary>Floor of the square root of a 64-bit integer, bit by bit.</summary>
+inline uint32_t isqrt64(uint64_t x)
+{
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > x) bit >>= 2;
+    while (bit != 0)
+    {
+        if (x >= result + bit)
+        {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+inline fix16_t fix16_sqrt(fix16_t x)
+{
+    if (x <= 0) return 0;
+    // sqrt(x / 2^16) * 2^16 = sqrt(x * 2^16)
+    return (fix16_t)isqrt64((uint64_t)x << 16);
+}
+
+/// <summary>sqrt(max(0, a^2 - b^2)) without overflowing the squares. Used for the horizontal
+/// speed from surface and vertical speed.</summary>
+inline fix16_t fix16_sqrt_diff_squares(fix16_t a, fix16_t b)
+{
+    int64_t diff = (int64_t)a * a - (int64_t)b * b;
+    if (diff <= 0) return 0;
+    return fix16_saturate(isqrt64((uint64_t)diff));
+}
+
+/// <summary>Wrap an angle in degrees to (-180, 180].</summary>
+inline fix16_t fix16_wrap180(fix16_t degrees)
+{
+    const fix16_t FULL = F16(360);
+    degrees %= FULL;
+    if (degrees > F16(180)) degrees -= FULL;
+    else if (degrees <= -F16(180)) degrees += FULL;
+    return degrees;
+}
+
+/// <summary>Wrap an angle in degrees to [0, 360).</summary>
+inline fix16_t fix16_wrap360(fix16_t degrees)
+{
+    const fix16_t FULL = F16(360);
+    degrees %= FULL;
+    if (degrees < 0) degrees += FULL;
+    return degrees;
+}
+
+/// <summary>Signed fraction (-1..1) to a Simpit axis value.</summary>
+inline int16_t fix16_to_axis(fix16_t fraction)
+{
+    return (int16_t)fix16_to_int(fix16_mul(fix16_clamp(fraction, -FIX16_ONE, FIX16_ONE), F16(INT16_MAX)));
+}
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "Input.h"
 #include "Output.h"
+#include "ShiftChain.h"
 #include <pins_arduino.h> 
 #include <variant.h>
 
@@ -20,22 +21,31 @@ struct VirtualPin
     bool lastReadingState; 
     bool lastDebouncedState;
     bool hasBeenRead;
-    unsigned long lastDebounceTime;
-    unsigned long debounceDelay;
+    ButtonState latchedState;       // Unread edge overtaken by a newer one, NOT_READY if none
+    unsigned long debounceDelay;    // Milliseconds
+    unsigned long edgeMicros;       // Time of the last debounced edge, debounce is timed from it
+};
+
+// Edge captured by an interrupt, waiting for update() to apply it
+struct InputEdge
+{
+    byte vpin;
+    bool state;
+    uint32_t micros;
 };
 
 // ARDUINO PINS
 
-// Shift in A pins (8 registers)
-const int SHIFT_IN_A_LOAD_PIN = 12;
-const int SHIFT_IN_A_CLOCK_PIN = 14;
-const int SHIFT_IN_A_CLOCK_ENABLE_PIN = 13;
-const int SHIFT_IN_A_SERIAL_PIN = 15;
-// Shift in B pins (2 registers)
-const int SHIFT_IN_B_LOAD_PIN = 16;
-const int SHIFT_IN_B_CLOCK_PIN = 17;
-const int SHIFT_IN_B_CLOCK_ENABLE_PIN = 18;
-const int SHIFT_IN_B_SERIAL_PIN = 19;
+// Cycles to wait after each shift-in clock edge (~120ns), raise if bits come back shifted
+const int _SHIFT_IN_SETTLE_NOPS = 10;
+
+// 74HC165 chains: registers, load, clock, clock enable and serial pins, first virtual pin.
+// Chain A's boards are wired with their bits reversed.
+typedef ShiftInChain<8, 12, 14, 13, 15, 0, true, _SHIFT_IN_SETTLE_NOPS> _ChainA;
+typedef ShiftInChain<2, 16, 17, 18, 19, _ChainA::END, false, _SHIFT_IN_SETTLE_NOPS> _ChainB;
+typedef ShiftInChains<_ChainA, _ChainB> _Chains;
+// Virtual pin of each bit of the chain buffer
+typedef ShiftInPinTable<_Chains> _ChainPins;
 
 // Test pins
 const byte TEST_BUTTON = 51;
@@ -50,14 +60,58 @@ bool arduinoPins[18]; // States of the arduino pins
 bool testButton, testSwitch;
 // Analog states (Only for boolean analog interpretation)
 bool translationButton, rotationButton;
-// ShiftIn states
-bool _sIA[64];
-bool _sIB[16];
+
+// Virtual pins of the inputs that are not on a chain
+const int _TEST_BUTTON_VPIN = _Chains::END;
+const int _TEST_SWITCH_VPIN = _Chains::END + 1;
+const int _TRANSLATION_BUTTON_VPIN = _Chains::END + 2;
+const int _ROTATION_BUTTON_VPIN = _Chains::END + 3;
+const int _FIRST_DIRECT_VPIN = _Chains::END + 4;
+const int _VIRTUAL_PIN_COUNT = _FIRST_DIRECT_VPIN + 18;
+static_assert(_TRANSLATION_BUTTON_VPIN == VPIN_TRANSLATION_BUTTON && _ROTATION_BUTTON_VPIN == VPIN_ROTATION_BUTTON,
+    "Input.h virtual pins do not match the input chains");
+
+// Chain levels by virtual pin
+bool _chainLevels[_Chains::END];
+
+// Raw shift register bytes as they come off the chains, back to back in chain order
+byte _raw[_Chains::BYTES];
+
+// Port and mask of each direct pin for reads from interrupts
+FastPin _directInputPins[18];
+
+// Capture state. Every producer runs at _CAPTURE_IRQ_PRIORITY so they never preempt
+// each other, which keeps the queue single-producer/single-consumer.
+const uint32_t _CAPTURE_IRQ_PRIORITY = 8;
+#define _CAPTURE_TC TC1
+#define _CAPTURE_TC_CHANNEL 2
+#define _CAPTURE_TC_IRQ TC5_IRQn
+#define _CAPTURE_TC_ID ID_TC5
+
+bool _capturing = false;
+volatile InputEdge _edgeQueue[CAPTURE_QUEUE_SIZE];
+volatile uint32_t _edgeHead = 0;    // Written by interrupts only
+volatile uint32_t _edgeTail = 0;    // Written by update() only
+volatile uint32_t _edgeCount = 0;
+volatile uint32_t _edgeOverflows = 0;
+volatile uint32_t _scanCount = 0;
+uint32_t _edgeMaxDepth = 0;
+byte _scanRaw[_Chains::BYTES];      // Last bytes seen by the timer scan
+volatile bool _directLast[18];      // Last level seen by each direct pin interrupt
+
+// Activity seen by update(), for idle detection. The axes are sampled one per update.
+const int _ACTIVITY_AXIS_PINS[7] = {
+    THROTTLE_AXIS_PIN,
+    TRANSLATION_X_AXIS_PIN, TRANSLATION_Y_AXIS_PIN, TRANSLATION_Z_AXIS_PIN,
+    ROTATION_X_AXIS_PIN, ROTATION_Y_AXIS_PIN, ROTATION_Z_AXIS_PIN
+};
+int _axisActivityLevel[7];          // Reading at the last counted move
+byte _nextActivityAxis = 0;
+uint32_t _activityCount = 0;
 
 // Holds all of the virtual pins
-VirtualPin* pins = nullptr;
-// Size of pins array (dynamically set)
-int numPins = 0;
+VirtualPin pins[_VIRTUAL_PIN_COUNT];
+const int numPins = _VIRTUAL_PIN_COUNT;
 
 Stream* debugSerial = nullptr;
 
@@ -67,41 +121,39 @@ Stream* debugSerial = nullptr;
 /// <param name="debounce">Debounce for this virtual pin.</param>
 void AddInput(bool& referenceToBoolVal, int virtualPin, int debounce = 100)
 {
-    // If the new pin is outside the current array bounds, we need to resize.
-    if (virtualPin >= numPins) {
-        int newSize = virtualPin + 1;
-        VirtualPin* newPins = new VirtualPin[newSize];
-
-        // Copy existing inputs to the new array
-        for (int i = 0; i < numPins; i++) {
-            newPins[i] = pins[i];
-        }
-        
-        // Initialize the new elements that are not the one we are adding now
-        for (int i = numPins; i < newSize; i++) {
-            newPins[i].value = nullptr; // Or some other safe default
-            newPins[i].lastReadingState = false;
-            newPins[i].lastDebouncedState = false;
-            newPins[i].lastDebounceTime = 0;
-            newPins[i].debounceDelay = 100;
-            newPins[i].hasBeenRead = true;
-        }
-
-        // Delete the old array
-        delete[] pins;
-        
-        // Update to the new array and size
-        pins = newPins;
-        numPins = newSize;
-    }
-
-    // Now, we can safely add/overwrite the input at the specified index
     pins[virtualPin].value = &referenceToBoolVal;
     pins[virtualPin].lastReadingState = *pins[virtualPin].value;
     pins[virtualPin].lastDebouncedState = *pins[virtualPin].value;
-    pins[virtualPin].lastDebounceTime = millis();
     pins[virtualPin].debounceDelay = debounce;
     pins[virtualPin].hasBeenRead = true;
+    pins[virtualPin].latchedState = NOT_READY;
+    pins[virtualPin].edgeMicros = micros();
+}
+
+/// <summary>True once the debounce delay has passed since the last edge. All times are micros(), the
+/// capture stamps edges with it too.</summary>
+bool _isDebouncePassed(const VirtualPin& pin, unsigned long nowMicros)
+{
+    unsigned long delayMicros = pin.debounceDelay * 1000UL;
+    // An edge drained after a later poll can be stamped a little before the last edge. Its unsigned
+    // elapsed time wraps to a huge value, so check how far behind it is as well: that is a bounce too.
+    return nowMicros - pin.edgeMicros > delayMicros && pin.edgeMicros - nowMicros > delayMicros;
+}
+
+/// <summary>Debounce a reading of a virtual pin taken at a given time.</summary>
+void _debounce(VirtualPin& pin, bool reading, unsigned long nowMicros)
+{
+    bool isDebouncePassed = _isDebouncePassed(pin, nowMicros);
+
+    if (reading != pin.lastDebouncedState && isDebouncePassed)
+    {
+        // Keep a short press that nobody has read yet, it is returned before the newer edge
+        if (!pin.hasBeenRead && pin.latchedState == NOT_READY)
+            pin.latchedState = pin.lastDebouncedState ? ON : OFF;
+        pin.lastDebouncedState = reading;
+        pin.hasBeenRead = false;
+        pin.edgeMicros = nowMicros;
+    }
 }
 
 bool shouldReset = false;
@@ -126,21 +178,18 @@ ButtonState InputClass::getVirtualPin(int virtualPin, bool waitForChange)
         return NOT_READY;
     }
     
-    unsigned long now = millis();
-    bool currentReading = *pins[virtualPin].value;
-	unsigned long elapsed = now - pins[virtualPin].lastDebounceTime;
-    bool isDebouncePassed = elapsed > pins[virtualPin].debounceDelay;
-
-    if (currentReading != pins[virtualPin].lastDebouncedState && isDebouncePassed)
-    {
-        pins[virtualPin].lastDebounceTime = now;
-        pins[virtualPin].lastDebouncedState = currentReading;
-        pins[virtualPin].hasBeenRead = false;
-    }
+    _debounce(pins[virtualPin], *pins[virtualPin].value, micros());
     if (!waitForChange) 
     {
         return pins[virtualPin].lastDebouncedState ? ON : OFF;
     }
+    if (pins[virtualPin].latchedState != NOT_READY)
+    {
+        // Report the latched edge now, the current state stays unread for the next call
+        ButtonState latched = pins[virtualPin].latchedState;
+        pins[virtualPin].latchedState = NOT_READY;
+        return latched;
+    }
     if (!pins[virtualPin].hasBeenRead) 
     {
     	pins[virtualPin].hasBeenRead = true;
@@ -151,96 +200,112 @@ ButtonState InputClass::getVirtualPin(int virtualPin, bool waitForChange)
 
 void initVirtualPins()
 {
-    const int totalPins = 102; // 84+18 = 102
-     // Clean up existing pins array if it exists
-    if (pins != nullptr) {
-        delete[] pins;
-    }
-    pins = new VirtualPin[totalPins];
-    numPins = totalPins;
-
-    for (int i = 0; i < 64; i++)
-    {
-        AddInput(_sIA[i], i, 150);
-    }
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < _Chains::BYTES; i++)
     {
-        AddInput(_sIB[i], i + 64, 150);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            byte vpin = _ChainPins::VPINS[i * 8 + bit];
+            AddInput(_chainLevels[vpin], vpin, 150);
+        }
     }
 
-    AddInput(testButton, 80, 150);
-    AddInput(testSwitch, 81, 150);
-    AddInput(translationButton, 82, 150);
-    AddInput(rotationButton, 83, 150);
+    AddInput(testButton, _TEST_BUTTON_VPIN, 150);
+    AddInput(testSwitch, _TEST_SWITCH_VPIN, 150);
+    AddInput(translationButton, _TRANSLATION_BUTTON_VPIN, 150);
+    AddInput(rotationButton, _ROTATION_BUTTON_VPIN, 150);
     for (int i = 0; i < 18; i++)
     {
-        AddInput(arduinoPins[i], i + 84, 150);
+        AddInput(arduinoPins[i], _FIRST_DIRECT_VPIN + i, 150);
     }
 }
+
 /// <summary>Gets shift register inputs.</summary>
-void _shiftIn(int dataA, int clockEnableA, int clockA, int loadA,
-              int dataB, int clockEnableB, int clockB, int loadB)
+void _shiftIn()
 {
-    // Clear values first
-    for (size_t i = 0; i < 64; i++) {
-        _sIA[i] = 0;
-    }
-    for (size_t i = 0; i < 16; i++) {
-        _sIB[i] = 0;
+    _Chains::read(_raw);
+    _Chains::unpack(_raw, _chainLevels);
+}
+
+/// <summary>Queue an edge. Only called from interrupts at the capture priority.</summary>
+void _pushEdge(byte vpin, bool state, uint32_t time)
+{
+    uint32_t head = _edgeHead;
+    if (head - _edgeTail >= CAPTURE_QUEUE_SIZE)
+    {
+        _edgeOverflows++;
+        return;
     }
-    // Then read and set values
-
-    // Pulse to A
-    digitalWrite(loadA, LOW);
-    delayMicroseconds(5);
-    digitalWrite(loadA, HIGH);
-    delayMicroseconds(5);
-    byte inputA[8];
-    // Get input A data
-    digitalWrite(clockA, HIGH);
-    digitalWrite(clockEnableA, LOW);
-    inputA[0] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[1] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[2] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[3] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[4] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[5] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[6] = shiftIn(dataA, clockA, LSBFIRST);
-    inputA[7] = shiftIn(dataA, clockA, LSBFIRST);
-    digitalWrite(clockEnableA, HIGH);
-
-    for (size_t i = 0; i < 64; i++)
+    volatile InputEdge& edge = _edgeQueue[head % CAPTURE_QUEUE_SIZE];
+    edge.vpin = vpin;
+    edge.state = state;
+    edge.micros = time;
+    // Publish after the entry is written
+    _edgeHead = head + 1;
+    _edgeCount++;
+}
+
+/// <summary>Queue edges for every bit that changed since the last scan.</summary>
+void _pushChainEdges(const byte now[], byte last[], uint32_t time)
+{
+    for (int i = 0; i < _Chains::BYTES; i++)
     {
-        byte byteIndex = i / 8;
-        byte bitIndex = 7 - (i % 8);
-        
-        if (byteIndex < 8 && bitRead(inputA[byteIndex], bitIndex)) {
-            _sIA[i] = 1;
+        byte changed = now[i] ^ last[i];
+        if (!changed) continue;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            if (!bitRead(changed, bit)) continue;
+            byte vpin = _ChainPins::VPINS[i * 8 + bit];
+            _pushEdge(vpin, bitRead(now[i], bit), time);
         }
+        last[i] = now[i];
     }
+}
+
+/// <summary>Pin change interrupt for a direct pin.</summary>
+void _directPinChanged(int index)
+{
+    bool state = fastRead(_directInputPins[index]);
+    // CHANGE can fire twice for one bounce, only queue real level changes
+    if (state == _directLast[index]) return;
+    _directLast[index] = state;
+    _pushEdge(_FIRST_DIRECT_VPIN + index, state, micros());
+}
 
-    // Pulse to B
-    digitalWrite(loadB, LOW);
-    delayMicroseconds(5);
-    digitalWrite(loadB, HIGH);
-    delayMicroseconds(5);
-    byte inputB[2];
-    // Get input B data
-    digitalWrite(clockB, HIGH);
-    digitalWrite(clockEnableB, LOW);
-    inputB[0] = shiftIn(dataB, clockB, LSBFIRST);
-    inputB[1] = shiftIn(dataB, clockB, LSBFIRST);
-    digitalWrite(clockEnableB, HIGH);
-
-    for (size_t i = 0; i < 16; i++)
+template <int INDEX>
+void _directPinISR()
+{
+    _directPinChanged(INDEX);
+}
+
+typedef void (*_PinISR)();
+const _PinISR _DIRECT_PIN_ISRS[18] = {
+    _directPinISR<0>,  _directPinISR<1>,  _directPinISR<2>,  _directPinISR<3>,
+    _directPinISR<4>,  _directPinISR<5>,  _directPinISR<6>,  _directPinISR<7>,
+    _directPinISR<8>,  _directPinISR<9>,  _directPinISR<10>, _directPinISR<11>,
+    _directPinISR<12>, _directPinISR<13>, _directPinISR<14>, _directPinISR<15>,
+    _directPinISR<16>, _directPinISR<17>
+};
+
+/// <summary>Apply queued edges to the virtual pins, debounced at the time they happened.</summary>
+/// <returns>Number of edges applied.</returns>
+uint32_t _drainEdges()
+{
+    uint32_t head = _edgeHead;
+    uint32_t tail = _edgeTail;
+    uint32_t count = head - tail;
+    if (count > _edgeMaxDepth) _edgeMaxDepth = count;
+
+    while (tail != head)
     {
-        byte byteIndex = i / 8;
-        byte bitIndex = i % 8;
-        
-        if (byteIndex < 2 && bitRead(inputB[byteIndex], bitIndex)) {
-            _sIB[i] = 1;
-        }
+        volatile InputEdge& edge = _edgeQueue[tail % CAPTURE_QUEUE_SIZE];
+        VirtualPin& pin = pins[edge.vpin];
+
+        *pin.value = edge.state;
+        _debounce(pin, edge.state, edge.micros);
+        tail++;
     }
+    _edgeTail = tail;
+    return count;
 }
 
 #pragma endregion
@@ -253,48 +318,55 @@ void InputClass::init(Stream& serial)
     debugSerial = &serial;  // Store Serial reference
     
     // Set pin modes
-    pinMode(SHIFT_IN_A_LOAD_PIN, OUTPUT);
-    pinMode(SHIFT_IN_A_CLOCK_PIN, OUTPUT);
-    pinMode(SHIFT_IN_A_CLOCK_ENABLE_PIN, OUTPUT);
-    pinMode(SHIFT_IN_A_SERIAL_PIN, INPUT);
-
-    pinMode(SHIFT_IN_B_LOAD_PIN, OUTPUT);
-    pinMode(SHIFT_IN_B_CLOCK_PIN, OUTPUT);
-    pinMode(SHIFT_IN_B_CLOCK_ENABLE_PIN, OUTPUT);
-    pinMode(SHIFT_IN_B_SERIAL_PIN, INPUT);
-    
-    for (auto pin : ARDUINO_PINS)
+    _Chains::begin();
+    for (int i = 0; i < 18; i++)
     {
-        pinMode(pin, INPUT_PULLUP);
+        pinMode(ARDUINO_PINS[i], INPUT_PULLUP);
+        _directInputPins[i] = fastPin(ARDUINO_PINS[i]);
     }
-	
-    // Set initial states
-    digitalWrite(SHIFT_IN_A_LOAD_PIN, HIGH);
-    digitalWrite(SHIFT_IN_A_CLOCK_PIN, LOW);
-    digitalWrite(SHIFT_IN_A_CLOCK_ENABLE_PIN, HIGH);
-
-    digitalWrite(SHIFT_IN_B_LOAD_PIN, HIGH);
-    digitalWrite(SHIFT_IN_B_CLOCK_PIN, LOW);
-    digitalWrite(SHIFT_IN_B_CLOCK_ENABLE_PIN, HIGH);
     
     // Initialize virtual pins
     initVirtualPins();
+
+    for (int i = 0; i < 7; i++)
+    {
+        _axisActivityLevel[i] = analogRead(_ACTIVITY_AXIS_PINS[i]);
+    }
     
     debugSerial->println("Input.cpp initialized.");
 }
 
 void InputClass::update()
 {
-    _shiftIn(SHIFT_IN_A_SERIAL_PIN, SHIFT_IN_A_CLOCK_ENABLE_PIN, SHIFT_IN_A_CLOCK_PIN, SHIFT_IN_A_LOAD_PIN,
-            SHIFT_IN_B_SERIAL_PIN, SHIFT_IN_B_CLOCK_ENABLE_PIN, SHIFT_IN_B_CLOCK_PIN, SHIFT_IN_B_LOAD_PIN);
+    bool lastButtons[4] = { testButton, testSwitch, translationButton, rotationButton };
+
+    if (_capturing)
+    {
+        // Shift registers and direct pins are read by interrupts
+        _activityCount += _drainEdges();
+    }
+    else
+    {
+        byte lastRaw[_Chains::BYTES];
+        bool lastPins[18];
+        memcpy(lastRaw, _raw, sizeof(lastRaw));
+        memcpy(lastPins, arduinoPins, sizeof(lastPins));
+
+        _shiftIn();
+        for (int i = 0; i < 18; i++)
+        {
+            arduinoPins[i] = digitalRead(ARDUINO_PINS[i]);
+        }
+
+        if (memcmp(lastRaw, _raw, sizeof(lastRaw)) != 0 || memcmp(lastPins, arduinoPins, sizeof(lastPins)) != 0)
+        {
+            _activityCount++;
+        }
+    }
 
     // Arduino Digital Pin reading
     testButton = digitalRead(TEST_BUTTON);
     testSwitch = digitalRead(TEST_SWITCH);
-    for (int i = 0; i < 18; i++)
-    {
-        arduinoPins[i] = digitalRead(ARDUINO_PINS[i]);
-    }
 
     // Arduino Analog reading (Only for boolean analog interpretation)
     // Read each button twice to allow the ADC multiplexer to settle between channels.
@@ -312,6 +384,21 @@ void InputClass::update()
     const int BUTTON_THRESHOLD = 950; // slightly above 3/4 scale to avoid noise
     translationButton = rawTrans > BUTTON_THRESHOLD;
     rotationButton = rawRot > BUTTON_THRESHOLD;
+
+    if (lastButtons[0] != testButton || lastButtons[1] != testSwitch
+        || lastButtons[2] != translationButton || lastButtons[3] != rotationButton)
+    {
+        _activityCount++;
+    }
+
+    // One axis per update keeps this cheap, a real move lasts many updates
+    int level = analogRead(_ACTIVITY_AXIS_PINS[_nextActivityAxis]);
+    if (abs(level - _axisActivityLevel[_nextActivityAxis]) > INPUT_AXIS_ACTIVITY_THRESHOLD)
+    {
+        _axisActivityLevel[_nextActivityAxis] = level;
+        _activityCount++;
+    }
+    _nextActivityAxis = (_nextActivityAxis + 1) % 7;
 }
 
 void InputClass::setAllVPinsReady()
@@ -320,9 +407,99 @@ void InputClass::setAllVPinsReady()
     {
         pins[i].lastReadingState = *pins[i].value; // ADDED: keep aligned
         pins[i].lastDebouncedState = *pins[i].value;
-        pins[i].lastDebounceTime = millis();
+        pins[i].edgeMicros = micros();
         pins[i].hasBeenRead = true;
+        pins[i].latchedState = NOT_READY;
+    }
+}
+
+void InputClass::clearEdge(int virtualPin)
+{
+    if (virtualPin < 0 || virtualPin >= numPins || pins[virtualPin].value == nullptr) return;
+    // Take in the current level first so it is not reported as a new edge later
+    _debounce(pins[virtualPin], *pins[virtualPin].value, micros());
+    pins[virtualPin].latchedState = NOT_READY;
+    pins[virtualPin].hasBeenRead = true;
+}
+
+unsigned long InputClass::getEdgeMicros(int virtualPin)
+{
+    if (virtualPin < 0 || virtualPin >= numPins) return 0;
+    return pins[virtualPin].edgeMicros;
+}
+
+/// <summary>Switch from polling to interrupt capture. Call after init() and a first update().</summary>
+void InputClass::beginCapture()
+{
+    if (_capturing) return;
+
+    // Start from the current levels so the first scan only queues real changes
+    _shiftIn();
+    memcpy(_scanRaw, _raw, sizeof(_scanRaw));
+    for (int i = 0; i < 18; i++)
+    {
+        arduinoPins[i] = fastRead(_directInputPins[i]);
+        _directLast[i] = arduinoPins[i];
     }
+    _edgeHead = _edgeTail = 0;
+    _capturing = true;
+
+    // Pin change interrupts
+    for (int i = 0; i < 18; i++)
+    {
+        attachInterrupt(ARDUINO_PINS[i], _DIRECT_PIN_ISRS[i], CHANGE);
+    }
+    NVIC_SetPriority(PIOA_IRQn, _CAPTURE_IRQ_PRIORITY);
+    NVIC_SetPriority(PIOB_IRQn, _CAPTURE_IRQ_PRIORITY);
+    NVIC_SetPriority(PIOC_IRQn, _CAPTURE_IRQ_PRIORITY);
+    NVIC_SetPriority(PIOD_IRQn, _CAPTURE_IRQ_PRIORITY);
+
+    // Shift register scan timer: TC1 channel 2 (TC5 interrupt), clocked from MCK/128
+    pmc_set_writeprotect(false);
+    pmc_enable_periph_clk(_CAPTURE_TC_ID);
+    TC_Configure(_CAPTURE_TC, _CAPTURE_TC_CHANNEL, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK4);
+    TC_SetRC(_CAPTURE_TC, _CAPTURE_TC_CHANNEL, VARIANT_MCK / 128 / CAPTURE_SCAN_HZ);
+    _CAPTURE_TC->TC_CHANNEL[_CAPTURE_TC_CHANNEL].TC_IER = TC_IER_CPCS;
+    _CAPTURE_TC->TC_CHANNEL[_CAPTURE_TC_CHANNEL].TC_IDR = ~TC_IER_CPCS;
+    NVIC_SetPriority(_CAPTURE_TC_IRQ, _CAPTURE_IRQ_PRIORITY);
+    NVIC_EnableIRQ(_CAPTURE_TC_IRQ);
+    TC_Start(_CAPTURE_TC, _CAPTURE_TC_CHANNEL);
+
+    if (debugSerial) debugSerial->println("Input capture started.");
+}
+
+bool InputClass::isCapturing()
+{
+    return _capturing;
+}
+
+uint32_t InputClass::getActivityCount()
+{
+    return _activityCount;
+}
+
+void InputClass::getCaptureStats(InputCaptureStats& stats)
+{
+    stats.edges = _edgeCount;
+    stats.overflows = _edgeOverflows;
+    stats.maxDepth = _edgeMaxDepth;
+    stats.scans = _scanCount;
+    _edgeMaxDepth = 0;
+}
+
+/// <summary>Scan every shift register chain and queue any changed bits.</summary>
+void InputClass::captureScanISR()
+{
+    byte raw[_Chains::BYTES];
+    _Chains::read(raw);
+    _pushChainEdges(raw, _scanRaw, micros());
+    _scanCount++;
+}
+
+void TC5_Handler()
+{
+    TC_GetStatus(_CAPTURE_TC, _CAPTURE_TC_CHANNEL);
+    Input.captureScanISR();
 }
 
 /*
@@ -416,18 +593,48 @@ void InputClass::debugInputState(int virtualPinNumber) {
     debugSerial->println(state == ON ? "ON" : state == OFF ? "OFF" : "NOT_READY");
 }
 
-#pragma endregion
+void InputClass::printState(Print& out)
+{
+    // While capturing only the timer scan reads the chains
+    byte raw[_Chains::BYTES];
+    noInterrupts();
+    memcpy(raw, _capturing ? _scanRaw : _raw, sizeof(raw));
+    interrupts();
+
+    out.print("Raw:");
+    for (int i = 0; i < _Chains::BYTES; i++)
+    {
+        out.print(' ');
+        out.print(raw[i], HEX);
+    }
+    out.println();
 
+    uint32_t direct = 0;
+    for (int i = 0; i < 18; i++)
+    {
+        if (arduinoPins[i]) direct |= (uint32_t)1 << i;
+    }
+    out.print("Direct pins: ");
+    out.println(direct, HEX);
 
-InputClass::~InputClass()
-{
-    if (pins != nullptr)
+    // Virtual pins 32 to a word, pin 0 in bit 0 of the first word
+    out.print("Debounced:");
+    for (int base = 0; base < numPins; base += 32)
     {
-        delete[] pins;
-        pins = nullptr; // Set to nullptr after deletion to avoid double deletion
+        uint32_t word = 0;
+        for (int bit = 0; bit < 32 && base + bit < numPins; bit++)
+        {
+            if (pins[base + bit].value != nullptr && pins[base + bit].lastDebouncedState)
+                word |= (uint32_t)1 << bit;
+        }
+        out.print(' ');
+        out.print(word, HEX);
     }
+    out.println();
 }
 
+#pragma endregion
+
 
 InputClass Input;
 
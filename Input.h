@@ -175,6 +175,22 @@ enum ButtonState
     #include "WProgram.h"
 #endif
 
+// Interrupt capture (see InputClass::beginCapture)
+#define CAPTURE_SCAN_HZ     1000    // Shift-register scan rate while capturing
+#define CAPTURE_QUEUE_SIZE  64      // Edge queue length, must be a power of two
+
+// ADC counts an axis has to move before it counts as activity (see InputClass::getActivityCount)
+#define INPUT_AXIS_ACTIVITY_THRESHOLD 8
+
+// Edge capture figures, see InputClass::getCaptureStats()
+struct InputCaptureStats
+{
+    uint32_t edges;         // Edges queued since capture began
+    uint32_t overflows;     // Edges dropped because the queue was full
+    uint32_t maxDepth;      // Deepest the queue has been between drains
+    uint32_t scans;         // Shift-register scans run by the timer
+};
+
 
 class InputClass
 {
@@ -187,6 +203,19 @@ public:
     void setAllVPinsReady();
 
     ButtonState getVirtualPin(int virtualPinNumber, bool waitForChange = true);
+    // Drop every unread edge of a virtual pin, the latched one included
+    void clearEdge(int virtualPinNumber);
+    // micros() of the last debounced edge on a virtual pin
+    unsigned long getEdgeMicros(int virtualPinNumber);
+    // Goes up whenever update() sees an input change or an axis move. Only compare it to an older value.
+    uint32_t getActivityCount();
+
+    // Interrupt capture: pin change interrupts on the direct pins and a timer scan of the shift registers
+    void beginCapture();
+    bool isCapturing();
+    void getCaptureStats(InputCaptureStats& stats);
+    // Shift-register scan, called from the timer interrupt
+    void captureScanISR();
 
     // Throttle
     int getThrottleAxis(); 
@@ -204,8 +233,8 @@ public:
     // Debugging
     void debugInputState(int virtualPinNumber);  
     void debugSASWarningButton();
-
-	~InputClass();  // Destructor declaration
+    // Raw shift register bytes, direct pin levels and debounced virtual pins, as hex words
+    void printState(Print& out);
 };
 
 extern InputClass Input;
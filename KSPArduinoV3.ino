@@ -8,6 +8,14 @@
 #include "Wire.h"
 #include "Output.h"
 #include "Input.h"
+#include "Sound.h"
+#include "Outbound.h"
+#include "Trace.h"
+#include "FixedPoint.h"
+#include "NavMath.h"
+#include "Link.h"
+#include "Warnings.h"
+#include "Console.h"
 #include <PayloadStructs.h>
 #include <KerbalSimpitMessageTypes.h>
 #include <KerbalSimpit.h>
@@ -44,87 +52,25 @@ public:
 };
 
 
+/// <summary>Steady tone on one voice of the Sound tone generator, used for the startup beep.
+/// Warning sounds are played by Warnings.</summary>
 class BeepSound {
     
 private:
 
-    Timer _timer;
-
-    bool _soundEnabled = true;
-    bool _isBeeping = false;
-
-    int* _pattern = nullptr;
-    int _patternLength = 0;
-    int _patternIndex = 0;
-    int _beepInterval = 0;
-
-    
+    byte _voice;
 
 public:
-    BeepSound() {}
-
-    // Mute/unmute this sound instance
-    void muteSound(bool isMute) {
-        _soundEnabled = !isMute;
-        if (isMute) {
-            Output.setSound(0, false);
-        }
-    }
-
-    // Start or stop a custom beep pattern
-    void beep(int* pattern, int patternLength, bool isEnabled, int beepRateMs) {
-        if (!_soundEnabled) return;
-
-        if (isEnabled) {
-            _pattern = pattern;
-            _patternLength = patternLength;
-            _isBeeping = true;
-            _beepInterval = beepRateMs;
-            _patternIndex = 0;
-            _timer.start(_beepInterval);
-        } else {
-            _isBeeping = false;
-            setSound(0, false);
-        }
-    }
-
-    // Non-blocking update function
-    void updateBeep() {
-        if (!_soundEnabled || !_isBeeping || _pattern == nullptr) return;
-
-        // When timer elapses, move to next tone
-        if (_timer.check()) {
-            int freq = _pattern[_patternIndex];
-            setSound(freq, (freq > 0));
-
-            _patternIndex++;
-            if (_patternIndex >= _patternLength) {
-                _patternIndex = 0; // Loop pattern
-            }
-
-            _timer.start(_beepInterval);
-        }
-    }
+    BeepSound(byte voice) : _voice(voice) {}
 
     void setSound(int frequency, bool enabled)
     {
-        if (enabled && frequency > 0) {
-            // Use analogWrite with 50% duty cycle to generate tone
-            // Arduino Due supports analogWrite on most pins
-            analogWrite(SOUND_PIN, 200); // 127 = 50% of 255
-            
-            // Note: This produces a fixed frequency PWM, not a true tone
-            // For proper tone generation, we'd need timer interrupts
-            // But this should produce audible sound on a buzzer
-        } else {
-            analogWrite(SOUND_PIN, 0);
-        }
+        Sound.setTone(_voice, enabled ? frequency : 0);
     }
 };
 
 // Global beep controller
-BeepSound beepSound;
-BeepSound beepSound2;  // Second beep controller
+BeepSound beepSound(0);
 
 int PATTERN_COMMS[] = {1000};
 int PATTERN_TEMP[] = {2000, 0};
@@ -188,14 +134,136 @@ targetMessage targetMsg;
 actionGroups ag;
 String soi = "";
 
-// Track vessel changes (use multiple properties to distinguish vessel change from staging)
-byte lastVesselStage = 255;  // 255 = uninitialized
-byte lastVesselType = 255;   // Track vessel type to detect actual vessel changes
-byte lastCrewCount = 255;    // Track crew count as additional identifier
+// Vessel change reconciliation: switches that must agree with the game state
+// before their controls are live again. Only mismatched switches are locked.
+enum ReconcileItem
+{
+    RECONCILE_SAS,
+    RECONCILE_RCS,
+    RECONCILE_GEAR,
+    RECONCILE_LIGHTS,
+    RECONCILE_BRAKE,
+    RECONCILE_DOCKING,
+    RECONCILE_DUAL,
+    RECONCILE_NAV,
+    RECONCILE_VIEW,
+    RECONCILE_AUTOPILOT,
+    RECONCILE_ITEM_COUNT
+};
+
+enum ReconcileState
+{
+    RECONCILE_IDLE,             // Nothing to reconcile, all controls live
+    RECONCILE_WAITING_STATUS,   // Vessel changed, waiting for fresh action status
+    RECONCILE_PENDING           // Waiting for the user to correct mismatched switches
+};
+
+const byte RECONCILE_PINS[RECONCILE_ITEM_COUNT] = {
+    VPIN_SAS_SWITCH, VPIN_RCS_SWITCH, VPIN_GEAR_SWITCH, VPIN_LIGHTS_SWITCH, VPIN_BRAKE_SWITCH,
+    VPIN_DOCKING_SWITCH, VPIN_DUAL_SWITCH, VPIN_NAV_SWITCH, VPIN_VIEW_SWITCH, VPIN_AUTO_PILOT_SWITCH
+};
+const char* const RECONCILE_NAMES[RECONCILE_ITEM_COUNT] = {
+    "SAS", "RCS", "Gear", "Lights", "Brake",
+    "Docking", "Dual/Single", "NAV/FLI", "IVA/EXT", "Autopilot"
+};
+
+ReconcileState reconcileState = RECONCILE_IDLE;
+uint16_t reconcileMismatch = 0;         // One bit per ReconcileItem still waiting for the user
+unsigned long reconcileStartTime = 0;
+bool actionStatusReceived = false;      // Set by the ACTIONSTATUS handler
+
+// Warning rules, in WARNING_RULES order
+enum WarningRuleId
+{
+    WARN_TEMP,
+    WARN_TEMP_CRITICAL,
+    WARN_OVERSPEED,
+    WARN_GEE,
+    WARN_GEE_CRITICAL,
+    WARN_GEAR_DOWN,
+    WARN_GEAR_SPEED,
+    WARN_WARP,
+    WARN_COMMS,
+    WARN_TERRAIN,
+    WARN_PULL_UP,
+    WARN_STALL,
+    WARN_RULE_COUNT
+};
+extern const WarningRule WARNING_RULES[WARN_RULE_COUNT];    // Defined after the functions it reads from
+
+// Boot phases, timestamped once each with micros() since reset
+enum BootPhase
+{
+    BOOT_SETUP_START,
+    BOOT_IO_READY,
+    BOOT_SELF_TEST_DONE,
+    BOOT_SIMPIT_CONNECTED,
+    BOOT_FIRST_FRAME,       // Channel registration, the first outbound frames after the handshake
+    BOOT_PHASE_COUNT
+};
+
+// Background LED/LCD self-test steps
+enum SelfTestStep
+{
+    SELF_TEST_ALL_OFF,
+    SELF_TEST_ALL_ON,
+    SELF_TEST_FINAL_OFF,
+    SELF_TEST_DONE
+};
+
+unsigned long bootPhaseMicros[BOOT_PHASE_COUNT];
+byte bootPhasesReached = 0;             // One bit per BootPhase
+SelfTestStep selfTestStep = SELF_TEST_ALL_OFF;
+unsigned long selfTestStepStart = 0;
+bool startupBeepActive = false;
 
 byte infoMode = 0;       // Track which info mode (1-12)
 byte directionMode = 0;  // Track which direction mode (1-12)
 
+// Last rendered text of each info and direction page, see setInfoLCD() and setDirectionLCD()
+const byte LCD_PAGE_COUNT = 12;
+struct PageCache
+{
+    bool valid;
+    uint32_t stamp;         // Link.channelStamp() of the page's channels when it was rendered
+    uint32_t key;           // Local state the page shows (units, switches) when it was rendered
+    String top, bottom;
+};
+PageCache infoPages[LCD_PAGE_COUNT + 1];        // By mode, 0 is the "Select Mode" page
+PageCache directionPages[LCD_PAGE_COUNT + 1];
+
+// Message types each page reads, by mode
+const uint64_t INFO_PAGE_CHANNELS[LCD_PAGE_COUNT + 1] = {
+    0,
+    LINK_CHANNEL(APSIDES_MESSAGE) | LINK_CHANNEL(APSIDESTIME_MESSAGE),     // Apoapsis
+    LINK_CHANNEL(APSIDES_MESSAGE) | LINK_CHANNEL(APSIDESTIME_MESSAGE),     // Periapsis
+    LINK_CHANNEL(MANEUVER_MESSAGE),                                         // Node time
+    LINK_CHANNEL(MANEUVER_MESSAGE) | LINK_CHANNEL(BURNTIME_MESSAGE),       // Node burn
+    LINK_CHANNEL(ORBIT_MESSAGE),                                            // Period
+    LINK_CHANNEL(ORBIT_MESSAGE),                                            // LAN
+    LINK_CHANNEL(ORBIT_MESSAGE),                                            // Inclination
+    LINK_CHANNEL(BURNTIME_MESSAGE) | LINK_CHANNEL(VELOCITY_MESSAGE),       // Burn time and range
+    LINK_CHANNEL(DELTAV_MESSAGE),                                           // DeltaV
+    LINK_CHANNEL(VELOCITY_MESSAGE) | LINK_CHANNEL(ALTITUDE_MESSAGE),       // Landing time
+    LINK_CHANNEL(TARGETINFO_MESSAGE),                                       // Target
+    LINK_CHANNEL(DELTAV_MESSAGE) | LINK_CHANNEL(BURNTIME_MESSAGE)          // Stage DeltaV
+};
+const uint64_t DIRECTION_PAGE_CHANNELS[LCD_PAGE_COUNT + 1] = {
+    0,
+    LINK_CHANNEL(MANEUVER_MESSAGE),                                         // Maneuver
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Prograde
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Retrograde
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Normal
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Anti-Normal
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Radial In
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Radial Out
+    LINK_CHANNEL(TARGETINFO_MESSAGE),                                       // Target
+    LINK_CHANNEL(TARGETINFO_MESSAGE),                                       // Anti-Target
+    LINK_CHANNEL(ROTATION_DATA_MESSAGE),                                    // Velocity
+    LINK_CHANNEL(ALTITUDE_MESSAGE),                                         // Autopilot
+    0                                                                       // Throttle, see directionPageKey()
+};
+
 
 /////////////////////////////////////////////////////////////////
 /////////////////////// Configing stuff /////////////////////////
@@ -220,25 +288,59 @@ const unsigned long GEAR_WARNING_BLINK_INTERVAL = 250;
 const unsigned long PITCH_WARNING_BLINK_INTERVAL = 200;
 const unsigned long AUTOPILOT_LED_BLINK_INTERVAL = 1000;
 
-// Startup delays (milliseconds)
-const unsigned long STARTUP_BEEP_DELAY = 200;
+// Vessel change reconciliation (milliseconds)
+const unsigned long RECONCILE_STATUS_TIMEOUT = 500;   // Max wait for fresh action status
+const unsigned long RECONCILE_PROMPT_INTERVAL = 1500; // Re-print mismatched switches
+
+// Vessel identity
+const byte VESSEL_CACHE_SIZE = 4;                   // Recently flown vessels whose settings are kept
+const unsigned long VESSEL_ID_SETTLE_TIME = 250;    // Name and type arrive separately, wait for both (milliseconds)
 
-// Warning thresholds
-const byte COMMS_WARNING_THRESHOLD = 50; // 50%
-const int LOW_ALTITUDE_WARNING_THRESHOLD = 200; // TERRAIN warning: below this altitude in meters (match KSP mod)
-const float TIME_TO_IMPACT_WARNING_THRESHOLD = 5.0; // PULL UP warning: time to impact in seconds (match KSP mod)
-const float HIGH_GEE_WARNING_SOLID_THRESHOLD = 4.5; // 4.5G (slow beeping)
-const float HIGH_GEE_WARNING_BLINKING_THRESHOLD = 6.5; // 6.5G (fast beeping)
-const byte HIGH_TEMP_WARNING_SOLID_THRESHOLD = 60; // 60%
-const byte HIGH_TEMP_WARNING_BLINKING_THRESHOLD = 80; // 80%
-const float GEAR_SPEED_WARNING_THRESHOLD = 100.0; // 100 m/s
-const float OVERSPEED_THRESHOLD = 900.0; // 900 m/s
-const float OVERSPEED_ALTITUDE_THRESHOLD = 15000.0; // 15 km
+// Startup (milliseconds)
+const bool FAST_BOOT = true;                        // Self-test runs in the background while connecting
+const unsigned long STARTUP_BEEP_DELAY = 200;
+const unsigned long SELF_TEST_STEP_INTERVAL = FAST_BOOT ? 250 : 1500;
+const unsigned long SIMPIT_HANDSHAKE_INTERVAL = 100; // Time between handshake attempts
+
+// Input
+const bool INPUT_CAPTURE = true;    // Read inputs from interrupts instead of once per loop
+
+// Idle
+const bool IDLE_SLEEP = true;                   // Sleep between interrupts when nothing is happening
+const unsigned long IDLE_AFTER_FRAMES = 1000;   // Quiet loops (no input, axis move or inbound byte) before going idle
+
+// Debug
+const byte TRACE_LINES_PER_LOOP = 2;    // Trace lines sent to the KSP screen per loop
+
+// Warning thresholds (see WARNING_RULES). Each warning clears at its _CLEAR value, so a value
+// hovering near the threshold does not make the light or sound chatter.
+const fix16_t COMMS_WARNING_THRESHOLD = F16(49); // Below 50%, the percentage is a whole number
+const fix16_t COMMS_WARNING_CLEAR = F16(55);
+const fix16_t LOW_ALTITUDE_WARNING_THRESHOLD = F16(200); // TERRAIN warning: below this altitude in meters (match KSP mod)
+const fix16_t LOW_ALTITUDE_WARNING_CLEAR = F16(220);
+const fix16_t TIME_TO_IMPACT_WARNING_THRESHOLD = F16(5.0); // PULL UP warning: time to impact in seconds (match KSP mod)
+const fix16_t TIME_TO_IMPACT_WARNING_CLEAR = F16(6.0);
+const fix16_t HIGH_GEE_WARNING_SOLID_THRESHOLD = F16(4.5); // 4.5G
+const fix16_t HIGH_GEE_WARNING_SOLID_CLEAR = F16(4.2);
+const fix16_t HIGH_GEE_WARNING_BLINKING_THRESHOLD = F16(6.5); // 6.5G
+const fix16_t HIGH_GEE_WARNING_BLINKING_CLEAR = F16(6.2);
+const fix16_t HIGH_TEMP_WARNING_SOLID_THRESHOLD = F16(60); // 60%
+const fix16_t HIGH_TEMP_WARNING_SOLID_CLEAR = F16(57);
+const fix16_t HIGH_TEMP_WARNING_BLINKING_THRESHOLD = F16(80); // 80%
+const fix16_t HIGH_TEMP_WARNING_BLINKING_CLEAR = F16(77);
+const fix16_t GEAR_SPEED_WARNING_THRESHOLD = F16(100.0); // 100 m/s
+const fix16_t GEAR_SPEED_WARNING_CLEAR = F16(95.0);
+const fix16_t OVERSPEED_THRESHOLD = F16(900.0); // 900 m/s
+const fix16_t OVERSPEED_CLEAR = F16(880.0);
+const int32_t OVERSPEED_ALTITUDE_THRESHOLD = 15000; // 15 km
+const fix16_t STALL_SPEED_THRESHOLD = F16(100.0 * 0.44704); // 100 mph = 44.7 m/s
+const fix16_t STALL_SPEED_CLEAR = F16(110.0 * 0.44704);
+const unsigned int WARNING_HOLD_TIME = 300; // A warning follows its condition once the change has lasted this long (milliseconds)
 
 // Joystick configs
 const float JOYSTICK_SMOOTHING_FACTOR = 0.2;  // Adjust this value for more or less smoothing (For Rot and Trans)
-const int JOYSTICK_DEADZONE = 90;  // Deadzone range (within 90 from center = 512)
-const int JOYSTICK_DEADZONE_CENTER = 90;  // Snap centering
+const int JOYSTICK_DEADZONE = 90;  // Deadzone range (within 90 from center = 512), default for joystickDeadzone
+const int JOYSTICK_DEADZONE_CENTER = 90;  // Snap centering, default for joystickDeadzoneCenter
 const int CAMERA_DEADZONE = 150; // Deadzone for camera joystick
 
 // Throttle configs
@@ -253,14 +355,14 @@ const float MAX_PRECISION_MODIFIER = 1.0;  // Maximum 100%
 const float PRECISION_STEP = 0.1;          // Increment/decrement by 10%
 
 // Autopilot tuning constants
-const float AP_HEADING_K = 0.02;  // proportional gain for heading -> yaw input (deg -> fraction)
-const float AP_SPEED_K = 0.08;   // proportional gain for speed -> throttle fraction per m/s
-const float AP_THROTTLE_ADAPT_RATE = 0.005; // rate at which base throttle adapts to find equilibrium
-const float AP_ROLL_K = 0.0035;    // proportional gain for roll -> roll input (deg -> fraction)
-const float THROTTLE_SMOOTH_ALPHA = 0.8; // smoothing alpha for throttle changes (0..1)
+const fix16_t AP_HEADING_K = F16(0.02);  // proportional gain for heading -> yaw input (deg -> fraction)
+const fix16_t AP_SPEED_K = F16(0.08);   // proportional gain for speed -> throttle fraction per m/s
+const fix16_t AP_THROTTLE_ADAPT_RATE = F16(0.005); // rate at which base throttle adapts to find equilibrium
+const fix16_t AP_ROLL_K = F16(0.0035);    // proportional gain for roll -> roll input (deg -> fraction)
+const fix16_t THROTTLE_SMOOTH_ALPHA = F16(0.8); // smoothing alpha for throttle changes (0..1), default for throttleSmoothAlpha
 const float MIN_THROTTLE_FRACTION = 0.0; // allow throttle to go to zero when slowing down
-const float AUTOPILOT_ALT_PRIORITY_THRESHOLD = 5.0; // meters: if altitude error is larger, deprioritize speed matching
-const float AUTOPILOT_HEADING_PRIORITY_THRESHOLD = 2.0; // degrees: if heading error is larger, deprioritize speed matching
+const fix16_t AUTOPILOT_ALT_PRIORITY_THRESHOLD = F16(5.0); // meters: if altitude error is larger, deprioritize speed matching
+const fix16_t AUTOPILOT_HEADING_PRIORITY_THRESHOLD = F16(2.0); // degrees: if heading error is larger, deprioritize speed matching
 
 // Roll sensitivity
 const float ROLL_SENSITIVITY = 0.35;
@@ -268,6 +370,11 @@ const float ROLL_SENSITIVITY = 0.35;
 // Serial baud rate
 const unsigned long SERIAL_BAUD_RATE = 115200;
 
+// Diagnostics console (type help). On the native USB port it runs alongside Simpit. On the
+// programming port it shares Simpit's port, so it only runs while not connected and the debug switch is on.
+const bool CONSOLE_ON_NATIVE_USB = false;
+const byte CONSOLE_COMMAND_COUNT = 6;
+
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
@@ -285,12 +392,31 @@ bool useImperialUnits = false;  // Global flag for imperial/metric units
 int loopCount = 0;
 int previousMillis;  // For hz calculation
 
+// Tuning that can be changed from the console, see consoleSet()
+int joystickDeadzone = JOYSTICK_DEADZONE;
+int joystickDeadzoneCenter = JOYSTICK_DEADZONE_CENTER;
+fix16_t throttleSmoothAlpha = THROTTLE_SMOOTH_ALPHA;
+bool ledTestActive = false;         // Set by the console led command, stops the waiting-for-KSP blink
+extern const ConsoleCommand CONSOLE_COMMANDS[CONSOLE_COMMAND_COUNT];   // Defined after the command functions
+
+// Idle mode, see updateIdle()
+bool isIdle = false;
+unsigned long idleQuietFrames = 0;
+uint32_t lastActivityCount = 0;
+uint32_t idleEntries = 0;
+uint32_t idleMicros = 0;            // Time asleep since the last report
+uint32_t idleReportStart = 0;       // micros() of the last report
+
 // Autopilot state (repurposed from physical warp switch)
 bool autopilotEnabled = false;
-float autopilotHeading = 0.0f;
-float autopilotSpeed = 0.0f;
-float autopilotAltitude = 0.0f;
+// Hold targets in Q16.16 (altitude saturates at 32767 m)
+fix16_t autopilotHeading = 0;
+fix16_t autopilotSpeed = 0;
+fix16_t autopilotAltitude = 0;
 unsigned long autopilotEngageTime = 0;
+// Direction page bars
+int16_t sentThrottle = 0;               // Last throttle axis value sent to KSP
+int32_t burnStartDeltaV = 0;            // Full delta-v of the next maneuver node (m/s), 0 if none
 bool sasWasOnBeforeAutopilot = false;  // Track SAS state to restore after autopilot
 bool viewModeEnabled = false;  // Toggle state for translation button view mode
 
@@ -302,6 +428,31 @@ int16_t trimRotX = 0;
 int16_t trimRotY = 0;  // No default pitch trim
 int16_t trimRotZ = 0;
 
+// Vessel identity: FNV-1a hash of the vessel name, continued over the vessel type
+const uint32_t FNV_OFFSET_BASIS = 2166136261UL;
+const uint32_t FNV_PRIME = 16777619UL;
+
+// Controller settings kept per vessel, see saveVesselState()
+struct VesselState
+{
+    uint32_t id;                // 0 = empty slot
+    uint32_t lastUsed;          // vesselUseCounter when last flown, the oldest is replaced first
+    int16_t trimTransX, trimTransY, trimTransZ;
+    int16_t trimRotX, trimRotY, trimRotZ;
+    float precisionModifier;
+    fix16_t autopilotHeading, autopilotSpeed, autopilotAltitude;
+    bool viewModeEnabled;
+    speedMode navballSpeedMode;
+};
+
+uint32_t vesselNameHash = 0;            // Hash of the last VESSEL_NAME_MESSAGE
+bool vesselNameReceived = false;
+uint32_t currentVesselId = 0;           // 0 = no vessel yet
+uint32_t pendingVesselId = 0;           // New identity waiting out VESSEL_ID_SETTLE_TIME
+unsigned long pendingVesselSince = 0;
+VesselState vesselCache[VESSEL_CACHE_SIZE];
+uint32_t vesselUseCounter = 0;
+
 // Camera control
 unsigned long lastCameraUpdate = 0;
 
@@ -318,6 +469,8 @@ Timer lcdTimer;
 Timer twoSecondTimer;
 Timer throttleDebugTimer;
 Timer manualRefreshTimer;
+Timer reconcilePromptTimer;
+Timer handshakeTimer;
 
 
 
@@ -327,33 +480,32 @@ Timer manualRefreshTimer;
 
 void setup()
 {
-     
+    markBootPhase(BOOT_SETUP_START);
     loopCount = 0;
     timer.start(MAIN_LOOP_INTERVAL);
     lcdTimer.start(LCD_UPDATE_INTERVAL);
     twoSecondTimer.start(TWO_SECOND_INTERVAL);
     throttleDebugTimer.start(THROTTLE_DEBUG_INTERVAL);
     manualRefreshTimer.start(MANUAL_REFRESH_INTERVAL);
+    handshakeTimer.start(SIMPIT_HANDSHAKE_INTERVAL);
     // Open up the serial port
     Serial.begin(SERIAL_BAUD_RATE);
+    if (CONSOLE_ON_NATIVE_USB)
+        SerialUSB.begin(SERIAL_BAUD_RATE);
+    Console.init(CONSOLE_COMMANDS, CONSOLE_COMMAND_COUNT);
     // Init I/O
     initIO();
 
-    // Show initializing messages on the LCDs during startup
-    // Show the same initializing message on all LCDs
-    Output.setSpeedLCD("Initializing", "Waiting...");
-    Output.setAltitudeLCD("Initializing", "Waiting...");
-    Output.setHeadingLCD("Initializing", "Waiting...");
-    Output.setInfoLCD("Initializing", "Waiting...");
-    Output.setDirectionLCD("Initializing", "Waiting...");
-    Output.update();
-	
-    // Test beep on startup
-    beepSound.setSound(1000, true);
-    beepSound.updateBeep();
-    delay(STARTUP_BEEP_DELAY);
-    beepSound.setSound(0, false);
-    beepSound.updateBeep();
+    // Self-test (LEDs, LCDs, startup beep) runs from loop() alongside the Simpit handshake
+    startSelfTest();
+    if (!FAST_BOOT)
+    {
+        while (selfTestStep != SELF_TEST_DONE)
+        {
+            updateSelfTest();
+            Output.update();
+        }
+    }
 
     Output.setLED(POWER_LED, true);
     while (Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) == ON)
@@ -361,20 +513,8 @@ void setup()
         preKSPConnectionLoop();
     }
     Output.setLED(POWER_LED, true);
-	printDebug("Starting Simpit");
-	setAllOutputs(true);
-    ///// Initialize Simpit
-    initSimpit();
-
-    // Additional things to do at start AFTER initialization
-
-    
-    //waitForInputEnable();
-    mySimpit.update();
-
-    // Initialization complete
-    printDebug("Initialization Complete!");
-
+	TRACE(TRACE_STARTING_SIMPIT);
+    // Simpit handshake and channel registration happen in loop(), see updateSimpitConnection()
 } 
 
 void loop() 
@@ -382,18 +522,55 @@ void loop()
     loopCount++;
     // Update input from controller (Refresh inputs)
     Input.update();
+    // Step the background self-test animation
+    updateSelfTest();
+    updateConsole();
+    if (twoSecondTimer.check())
+        reportIdle();
+    if (updateIdle())
+    {
+        // Nothing has changed, so skip refresh and the LCDs. Keep the handshake and queued output going.
+        updateSimpitConnection();
+        if (isConnectedToKSP)
+            updateLinkHealth();
+        drainTrace();
+        Outbound.update();
+        // LED effects keep running while idle
+        Output.updateLEDs();
+        idleSleep();
+        return;
+    }
+    if (!isConnectedToKSP)
+    {
+        // Keep trying the handshake without blocking
+        updateSimpitConnection();
+        drainTrace();
+        Output.update();
+        return;
+    }
     // Update simpit (receive messages from KSP including CAG status)
     mySimpit.update();
+    // Back to the handshake if KSP has gone quiet
+    if (!updateLinkHealth())
+        return;
     // This ensures LEDs stay in sync even if a message is missed
     if (manualRefreshTimer.check() && isConnectedToKSP)
     {
-        mySimpit.requestMessageOnChannel(ACTIONSTATUS_MESSAGE);
-        mySimpit.requestMessageOnChannel(CAGSTATUS_MESSAGE);
-        mySimpit.requestMessageOnChannel(SAS_MODE_INFO_MESSAGE);
-        mySimpit.requestMessageOnChannel(SOI_MESSAGE);
+        Outbound.requestMessageOnChannel(ACTIONSTATUS_MESSAGE);
+        Outbound.requestMessageOnChannel(CAGSTATUS_MESSAGE);
+        Outbound.requestMessageOnChannel(SAS_MODE_INFO_MESSAGE);
+        Outbound.requestMessageOnChannel(SOI_MESSAGE);
+        if (!vesselNameReceived)
+            Outbound.requestMessageOnChannel(VESSEL_NAME_MESSAGE);
     }
+    // Detect a vessel switch, then advance the reconciliation (never blocks)
+    updateVesselIdentity();
+    updateVesselReconcile();
     // Refresh logic, I/O, etc. This is all local to KSPArduino.ino
     refresh();
+    // Debug output, then send queued messages to KSP, as many as the serial TX buffer can take
+    drainTrace();
+    Outbound.update();
     // Update output to controller (send LED states to hardware)
     Output.update();
 } 
@@ -403,26 +580,115 @@ void initIO()
 {
     // Initialize Output
     Output.init();
+    // Initialize Sound
+    Sound.init(SOUND_PIN);
+    // Warning rules drive their LEDs and sounds from here on
+    Warnings.init(WARNING_RULES, WARN_RULE_COUNT);
     // Initialize Input
     Input.init(Serial);
     Input.setAllVPinsReady();
-	
-	// Test I/O
-	printDebug("Testing I/O");
-	// Output
-	setAllOutputs(false);
-    Output.update();
-	delay(1500);
-	setAllOutputs(true);
-    Output.update();
-	delay(1500);
-	setAllOutputs(false);
-    Output.update();
 
     // Input
     Input.update();
+    if (INPUT_CAPTURE)
+        Input.beginCapture();
 	// Done
-	printDebug("I/O Initialized");
+    markBootPhase(BOOT_IO_READY);
+	TRACE(TRACE_IO_INITIALIZED);
+}
+
+/// <summary>Record the time a boot phase was first reached.</summary>
+void markBootPhase(BootPhase phase)
+{
+    if (bitRead(bootPhasesReached, phase))
+        return;
+    bootPhaseMicros[phase] = micros();
+    bitSet(bootPhasesReached, phase);
+}
+
+/// <summary>Time a boot phase was reached in ms since reset, -1 if it has not been.</summary>
+long bootPhaseMillis(BootPhase phase)
+{
+    return bitRead(bootPhasesReached, phase) ? (long)(bootPhaseMicros[phase] / 1000) : -1;
+}
+
+/// <summary>Trace the boot timeline.</summary>
+void reportBootTimes()
+{
+    TRACE(TRACE_BOOT_TIMES, bootPhaseMillis(BOOT_SETUP_START), bootPhaseMillis(BOOT_IO_READY), bootPhaseMillis(BOOT_SELF_TEST_DONE));
+    TRACE(TRACE_BOOT_TIMES_2, bootPhaseMillis(BOOT_SIMPIT_CONNECTED), bootPhaseMillis(BOOT_FIRST_FRAME));
+}
+
+/// <summary>Begin the LED/LCD self-test and the startup beep.</summary>
+void startSelfTest()
+{
+	TRACE(TRACE_TESTING_IO);
+    selfTestStep = SELF_TEST_ALL_OFF;
+    selfTestStepStart = millis();
+    setAllOutputs(false);
+
+    // Test beep on startup, stopped by updateSelfTest()
+    beepSound.setSound(1000, true);
+    startupBeepActive = true;
+}
+
+/// <summary>Stop the startup beep and give its voice back to the warnings.</summary>
+void stopStartupBeep()
+{
+    if (!startupBeepActive)
+        return;
+    beepSound.setSound(0, false);
+    startupBeepActive = false;
+    Warnings.refresh();
+}
+
+/// <summary>Non-blocking self-test animation: all off, all on, all off. Cut short once KSP connects,
+/// from then on the LEDs and LCDs belong to refresh() and the warnings.</summary>
+void updateSelfTest()
+{
+    if (startupBeepActive && millis() - selfTestStepStart >= STARTUP_BEEP_DELAY && selfTestStep == SELF_TEST_ALL_OFF)
+        stopStartupBeep();
+
+    if (selfTestStep == SELF_TEST_DONE)
+        return;
+    if (isConnectedToKSP)
+    {
+        stopStartupBeep();
+        selfTestStep = SELF_TEST_DONE;
+        markBootPhase(BOOT_SELF_TEST_DONE);
+        TRACE(TRACE_IO_TESTED);
+        return;
+    }
+    if (millis() - selfTestStepStart < SELF_TEST_STEP_INTERVAL)
+        return;
+
+    selfTestStepStart = millis();
+    switch (selfTestStep)
+    {
+    case SELF_TEST_ALL_OFF:
+        stopStartupBeep();
+        setAllOutputs(true);
+        selfTestStep = SELF_TEST_ALL_ON;
+        break;
+    case SELF_TEST_ALL_ON:
+        setAllOutputs(false);
+        selfTestStep = SELF_TEST_FINAL_OFF;
+        break;
+    case SELF_TEST_FINAL_OFF:
+        selfTestStep = SELF_TEST_DONE;
+        markBootPhase(BOOT_SELF_TEST_DONE);
+        // All LEDs on while waiting for KSP
+        setAllOutputs(true);
+        Output.setSpeedLCD("Waiting for Simpit", "");
+        Output.setAltitudeLCD("Waiting for Simpit", "");
+        Output.setHeadingLCD("Waiting for Simpit", "");
+        Output.setInfoLCD("Waiting for Simpit", "");
+        Output.setDirectionLCD("Waiting for Simpit", "");
+        TRACE(TRACE_IO_TESTED);
+        break;
+    default:
+        break;
+    }
 }
 
 void setAllOutputs(bool state)
@@ -440,16 +706,11 @@ void preKSPConnectionLoop()
     //////////////////////////////////////////////////////
     
     Input.update();
-    // Debug mode: allow LED testing via serial input
-    if (Input.getVirtualPin(VPIN_MOD_BUTTON, false) == ON)
-    {
-        while (Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) == ON)
-        {
-            serialLedTestDebug();
-            Input.update();
-        }
-    }
-    setAllOutputs(millis() % 1000 < 500);  // Blink all LEDs at 1Hz
+    // Debug mode: commands from the serial console, e.g. an LED test
+    updateConsole();
+    if (!ledTestActive)
+        setAllOutputs(millis() % 1000 < 500);  // Blink all LEDs at 1Hz
+    Output.updateLEDs();
     
     // Test all inputs, print when any button is pressed
     for (int i = 0; i < 102; i++)
@@ -457,7 +718,7 @@ void preKSPConnectionLoop()
         auto state = Input.getVirtualPin(i);
         if (state == ON)
         {
-            printDebug("Input " + String(i) + " pressed");
+            TRACE(TRACE_INPUT_PRESSED, i);
         }
     }
 
@@ -466,83 +727,146 @@ void preKSPConnectionLoop()
     uint32_t loopDelay = millis() - timeStart;
     if (twoSecondTimer.check())
     {
-        printDebug("\nLoop Rate: " + String(loopDelay));
-        printDebug(" ms\n------------END OF LOOP---------------");
+        TRACE(TRACE_LOOP_TIME, loopDelay);
+        OutputRefreshStats refreshStats;
+        Output.getRefreshStats(refreshStats);
+        TRACE(TRACE_LED_REFRESH, refreshStats.frameRateHz, refreshStats.cpuLoadPermille, refreshStats.maxIsrMicros);
+        if (Input.isCapturing())
+        {
+            InputCaptureStats captureStats;
+            Input.getCaptureStats(captureStats);
+            TRACE(TRACE_INPUT_CAPTURE, captureStats.edges, captureStats.overflows, captureStats.maxDepth);
+        }
+        TRACE(TRACE_END_OF_LOOP);
     }
+    drainTrace();
 }
-void serialLedTestDebug()
+/// <summary>Attempt the Simpit handshake at a fixed interval. Once it succeeds, register channels.</summary>
+void updateSimpitConnection()
 {
-    // Allow user to serial input pin number and enable that and disable all others
-	printDebug("\nEnter pin number to enable (0-145):");
-    // Clear any leftover data in serial buffer
-    while (Serial.available() > 0) {
-        Serial.read();
-    }
-    
-    // Wait for actual input
-    while (Serial.available() == 0) {}
-    
-    int pinToEnable = Serial.parseInt();
-    
-    // Clear remaining characters (like newline)
-    while (Serial.available() > 0) {
-        Serial.read();
-    }
-    
-    if (pinToEnable >= 0 && pinToEnable <= TOTAL_LEDS)
-    {
-        setAllOutputs(false);
-        Output.setLED(pinToEnable, true);
-        Output.update();
-        printDebug("LED " + String(pinToEnable) + " is now ON");
-	}
-    else
-    {
-        printDebug("Invalid pin number.");
-    }
-}
+    if (isConnectedToKSP || !handshakeTimer.check())
+        return;
+    if (!mySimpit.init())
+        return;
 
-void initSimpit()
-{
-    //Output.setSpeedLCD("Waiting for KSP", "");
-    Output.update();
-    // Wait for a connection to ksp
-    // Show waiting message and keep LCDs updated while waiting
-    // Show same waiting message on all LCDs and keep them updated while waiting
-    Output.setSpeedLCD("Waiting for Simpit", "");
-    Output.setAltitudeLCD("Waiting for Simpit", "");
-    Output.setHeadingLCD("Waiting for Simpit", "");
-    Output.setInfoLCD("Waiting for Simpit", "");
-    Output.setDirectionLCD("Waiting for Simpit", "");
-    Output.update();
-    while (!mySimpit.init()) {
-        delay(100);
-        Output.update();
-    }
-    while (!mySimpit.init()) {
-        delay(100);
-        Output.update();
-    }
-    
+    markBootPhase(BOOT_SIMPIT_CONNECTED);
     // Set connection flag
     isConnectedToKSP = true;
+    bool isReconnect = Link.getState() == LINK_DOWN && bootPhaseMillis(BOOT_FIRST_FRAME) >= 0;
+    Link.begin();
     
+    // All outgoing messages go through the priority queue
+    Outbound.init(mySimpit, Serial);
+    // Register a method for receiving simpit message from ksp
+    mySimpit.inboundHandler(myCallbackHandler);
+    // Register the simpit channels
+    registerSimpitChannels();
+    markBootPhase(BOOT_FIRST_FRAME);
+
     // Show that the controller has connected
-    printDebug("KSP Controller Connected!");
+    if (isReconnect)
+    {
+        LinkStats stats;
+        Link.getStats(stats);
+        TRACE(TRACE_LINK_RECONNECTED, stats.lastReconnectMillis, stats.reconnects);
+    }
+    else
+    {
+        TRACE(TRACE_CONNECTED);
+        reportBootTimes();
+    }
     // Update all LCDs to show successful connection
     Output.setSpeedLCD("Connected to KSP", "");
     Output.setAltitudeLCD("Connected to KSP", "");
     Output.setHeadingLCD("Connected to KSP", "");
     Output.setInfoLCD("Connected to KSP", "");
     Output.setDirectionLCD("Connected to KSP", "");
-    Output.update();
-    // Register a method for receiving simpit message from ksp
-    mySimpit.inboundHandler(myCallbackHandler);
-    // Register the simpit channels
-    registerSimpitChannels();
 }
 
-void printHz(String customTxt)
+/// <summary>Track activity and decide if this loop can sleep. Any input change, axis move or inbound
+/// byte keeps the controller awake for IDLE_AFTER_FRAMES more loops.</summary>
+/// <returns>True if the loop should sleep instead of refreshing.</returns>
+bool updateIdle()
+{
+    uint32_t activity = Input.getActivityCount();
+    bool active = activity != lastActivityCount
+        || Serial.available() > 0
+        || (CONSOLE_ON_NATIVE_USB && SerialUSB.available() > 0)
+        || selfTestStep != SELF_TEST_DONE;
+    lastActivityCount = activity;
+
+    if (active || !IDLE_SLEEP)
+    {
+        isIdle = false;
+        idleQuietFrames = 0;
+        return false;
+    }
+    if (!isIdle && ++idleQuietFrames >= IDLE_AFTER_FRAMES)
+    {
+        isIdle = true;
+        idleEntries++;
+    }
+    return isIdle;
+}
+
+/// <summary>Sleep until the next interrupt: serial receive, input scan, LED refresh or the 1 ms tick.</summary>
+void idleSleep()
+{
+    uint32_t start = micros();
+    __WFI();
+    idleMicros += micros() - start;
+}
+
+/// <summary>Trace the share of time spent asleep since the last report.</summary>
+void reportIdle()
+{
+    uint32_t now = micros();
+    uint32_t window = now - idleReportStart;
+    int percent = window > 0 ? (int)((uint64_t)idleMicros * 100 / window) : 0;
+    TRACE(TRACE_IDLE, percent, idleMicros / 1000, idleEntries);
+    idleMicros = 0;
+    idleReportStart = now;
+}
+
+/// <summary>Watch the inbound traffic: probe with an echo request while the link is degraded,
+/// and go back to the handshake once it is down.</summary>
+/// <returns>False if the link has just gone down.</returns>
+bool updateLinkHealth()
+{
+    static LinkState lastState = LINK_UP;
+    LinkState state = Link.update();
+    if (state == LINK_DEGRADED && lastState == LINK_UP)
+        TRACE(TRACE_LINK_DEGRADED, Link.millisSinceFrame());
+    lastState = state;
+
+    if (state == LINK_DEGRADED && Link.probeDue())
+    {
+        // Simpit answers an echo request even while the game is paused
+        byte probe = 0;
+        Outbound.sendBytes(ECHO_REQ_MESSAGE, &probe, 1, OUTBOUND_COMMAND);
+    }
+    if (state != LINK_DOWN)
+        return true;
+
+    // Stop sending axes into the void and reconnect in the background, see updateSimpitConnection()
+    isConnectedToKSP = false;
+    Outbound.clear();
+    Warnings.clear();
+    handshakeTimer.start(SIMPIT_HANDSHAKE_INTERVAL);
+    lastState = LINK_UP;
+
+    LinkStats stats;
+    Link.getStats(stats);
+    TRACE(TRACE_LINK_DOWN, stats.drops);
+    Output.setSpeedLCD("Link lost", "Reconnecting...");
+    Output.setAltitudeLCD("Link lost", "Reconnecting...");
+    Output.setHeadingLCD("Link lost", "Reconnecting...");
+    Output.setInfoLCD("Link lost", "Reconnecting...");
+    Output.setDirectionLCD("Link lost", "Reconnecting...");
+    return false;
+}
+
+void printHz()
 {
     // Measure the current time
     unsigned long currentMillis = millis();
@@ -552,113 +876,272 @@ void printHz(String customTxt)
 
     // Print the loop rate (inverse of the elapsed time)
     float loopRate = 1000.0 / elapsedTime;  // Convert to loops per second (Hz)
-    printDebug(String(customTxt) + ": " + String(loopRate) + " Hz");
+    TRACE(TRACE_LOOP_RATE, loopRate);
     // Update the previous timestamp for the next iteration
     previousMillis = currentMillis;
 }
 
-void vesselChange()
-{
-	// Request important states
-    mySimpit.requestMessageOnChannel(ACTIONSTATUS_MESSAGE);
-    mySimpit.requestMessageOnChannel(CAGSTATUS_MESSAGE);
-    mySimpit.requestMessageOnChannel(SAS_MODE_INFO_MESSAGE);
-	// Update everything else
-	mySimpit.update();
-
-    // Force-refresh CAG and action-group LED state so the controller reflects the
-    // new vessel's action availability immediately.
-    refreshCAGs();
-    setActionGroupLEDs();
-    setSASModeLEDs();
-
-    //delay(2000); // Wait a moment to ensure messages are received
-    //keyboardEmulatorMessage pauseMessage(0x1B); // ESC key
-    //mySimpit.send(KEYBOARD_EMULATOR, pauseMessage); // ESC key
-    mySimpit.printToKSP("Vessel change detected!", PRINT_TO_SCREEN);
-
-    // Print to KSP screen
-    mySimpit.printToKSP("Input deactivated!", PRINT_TO_SCREEN);
-	
-	// Blocking calls that must be met before controller continues
-	// SAS	
-	waitForUserCorrection(VPIN_SAS_SWITCH, (ag.isSAS) ? ON : OFF, "SAS");
-	// RCS
-	waitForUserCorrection(VPIN_RCS_SWITCH, (ag.isRCS) ? ON : OFF, "RCS");
-	// Locks should be off
-	//waitForUserCorrection(VPIN_THROTTLE_LOCK_SWITCH, OFF, "Throttle Lock");
-	//waitForUserCorrection(VPIN_STAGE_LOCK_SWITCH, OFF, "Stage Lock");
-	//waitForUserCorrection(VPIN_ABORT_LOCK_SWITCH, OFF, "Abort Lock");
-	//waitForUserCorrection(VPIN_WARP_LOCK_SWITCH, OFF, "Warp Lock");
-	// Toggle actions
-	// Gear
-	waitForUserCorrection(VPIN_GEAR_SWITCH, (!ag.isGear) ? ON : OFF, "Gear");
-	// Lights
-	waitForUserCorrection(VPIN_LIGHTS_SWITCH, (ag.isLights) ? ON : OFF, "Lights");
-	// Brake
-	waitForUserCorrection(VPIN_BRAKE_SWITCH, (ag.isBrake) ? ON : OFF, "Brake");
-	// Other values that should be off
-	//waitForUserCorrection(VPIN_PRECISION_SWITCH, OFF, "Precision");
-	waitForUserCorrection(VPIN_DOCKING_SWITCH, OFF, "Docking");
-    // UI
-    waitForUserCorrection(VPIN_DUAL_SWITCH, OFF, "Dual/Single");
-    // Nav
-    waitForUserCorrection(VPIN_NAV_SWITCH, OFF, "NAV/FLI");
-    // View
-    waitForUserCorrection(VPIN_VIEW_SWITCH, OFF, "IVA/EXT");
-    // Physical Warp
-    waitForUserCorrection(VPIN_AUTO_PILOT_SWITCH, OFF, "Autopilot");
-    // 
-
-
-    mySimpit.printToKSP("Inputs all set.", PRINT_TO_SCREEN);
-    // Print to KSP screen
-    mySimpit.printToKSP("Input reactivated!", PRINT_TO_SCREEN);
-    keyboardEmulatorMessage pauseMsg(0x1B); // ESC key
-    mySimpit.send(KEYBOARD_EMULATOR, pauseMsg);
-}
-
-void waitForUserCorrection(byte input, bool desiredState, String switchName)
-{
-    Timer waitTimer;
-    waitTimer.start(250);
-    String stateText = (desiredState == ON) ? "ON" : "OFF";
-    String message = "Set " + switchName + " to " + stateText;
-    bool shouldPrintSetMessage = false;
-	while (Input.getVirtualPin(input, false) != desiredState)
-	{
-        if (waitTimer.check())
+/// <summary>FNV-1a hash of some bytes, continued from a previous hash (start with FNV_OFFSET_BASIS).</summary>
+uint32_t fnv1a(const byte* data, int size, uint32_t hash)
+{
+    for (int i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/// <summary>Identity of the current vessel from its name and type, 0 until the name is known.</summary>
+uint32_t vesselIdentity()
+{
+    if (!vesselNameReceived)
+        return 0;
+    uint32_t id = fnv1a(&flightStatusMsg.vesselType, 1, vesselNameHash);
+    return id == 0 ? 1 : id;  // 0 means no vessel
+}
+
+/// <summary>Keep the controller settings of a vessel, replacing the least recently flown one if the cache is full.</summary>
+void saveVesselState(uint32_t id)
+{
+    if (id == 0)
+        return;
+
+    VesselState* slot = &vesselCache[0];
+    for (byte i = 0; i < VESSEL_CACHE_SIZE; i++)
+    {
+        if (vesselCache[i].id == id)
         {
-            mySimpit.printToKSP(message, PRINT_TO_SCREEN);
+            slot = &vesselCache[i];
+            break;
         }
-		delay(50);
-		Input.update();
-        mySimpit.update();  // Process incoming messages to update LEDs
-        Output.update();    // Update LED outputs
-        
-        // Update warning LEDs while waiting
-        setCommsWarning();
-        setAltWarning();
-        setPitchWarning();
-        setActionGroupLEDs();
-        // Keep audible warnings updated while waiting
-        updateWarningSound();
+        if (vesselCache[i].lastUsed < slot->lastUsed)
+            slot = &vesselCache[i];     // Empty slots have lastUsed 0 and win
+    }
+
+    slot->id = id;
+    slot->lastUsed = ++vesselUseCounter;
+    slot->trimTransX = trimTransX;
+    slot->trimTransY = trimTransY;
+    slot->trimTransZ = trimTransZ;
+    slot->trimRotX = trimRotX;
+    slot->trimRotY = trimRotY;
+    slot->trimRotZ = trimRotZ;
+    slot->precisionModifier = precisionModifier;
+    slot->autopilotHeading = autopilotHeading;
+    slot->autopilotSpeed = autopilotSpeed;
+    slot->autopilotAltitude = autopilotAltitude;
+    slot->viewModeEnabled = viewModeEnabled;
+    slot->navballSpeedMode = navballSpeedMode;
+}
+
+/// <summary>Load the cached settings of a vessel, or the defaults for one not flown recently.</summary>
+/// <returns>True if the vessel was in the cache.</returns>
+bool restoreVesselState(uint32_t id)
+{
+    VesselState state = {};
+    state.precisionModifier = DEFAULT_PRECISION_MODIFIER;
+    state.navballSpeedMode = SPEED_SURFACE_MODE;
+
+    bool cached = false;
+    for (byte i = 0; i < VESSEL_CACHE_SIZE; i++)
+    {
+        if (vesselCache[i].id == id)
+        {
+            vesselCache[i].lastUsed = ++vesselUseCounter;
+            state = vesselCache[i];
+            cached = true;
+            break;
+        }
+    }
+
+    trimTransX = state.trimTransX;
+    trimTransY = state.trimTransY;
+    trimTransZ = state.trimTransZ;
+    trimRotX = state.trimRotX;
+    trimRotY = state.trimRotY;
+    trimRotZ = state.trimRotZ;
+    precisionModifier = state.precisionModifier;
+    autopilotHeading = state.autopilotHeading;
+    autopilotSpeed = state.autopilotSpeed;
+    autopilotAltitude = state.autopilotAltitude;
+    viewModeEnabled = state.viewModeEnabled;
+    navballSpeedMode = state.navballSpeedMode;
+    currentSpeedMode = navballSpeedMode;
+    return cached;
+}
+
+/// <summary>Detect a switch to another vessel once its identity has settled, swap the per-vessel
+/// settings and start reconciling the switches. Staging and crew transfers keep the name and type.
+/// The identity is held while on EVA, so going out and back in is not a vessel change but boarding
+/// another vessel is. Called every loop.</summary>
+void updateVesselIdentity()
+{
+    if (!flightStatusMsg.isInFlight() || flightStatusMsg.isInEVA())
+    {
+        pendingVesselId = 0;
+        return;
+    }
 
-        // enable sound, ui, pause
-        refreshSoundSwitch();
-        refreshUI();
-        refreshPause();
+    uint32_t id = vesselIdentity();
+    if (id == 0 || id == currentVesselId)
+    {
+        pendingVesselId = 0;
+        return;
+    }
+    if (id != pendingVesselId)
+    {
+        pendingVesselId = id;
+        pendingVesselSince = millis();
+        return;
+    }
+    if (millis() - pendingVesselSince < VESSEL_ID_SETTLE_TIME)
+        return;
+
+    pendingVesselId = 0;
+    saveVesselState(currentVesselId);
+    bool cached = restoreVesselState(id);
+    currentVesselId = id;
+    TRACE(TRACE_VESSEL_CHANGED, id, cached);
+    beginVesselReconcile();
+}
+
+/// <summary>Start reconciling switches against a newly loaded vessel. Safe to call from the Simpit callback.</summary>
+void beginVesselReconcile()
+{
+    // Request important states, the answer is handled in updateVesselReconcile()
+    actionStatusReceived = false;
+    Outbound.requestMessageOnChannel(ACTIONSTATUS_MESSAGE);
+    Outbound.requestMessageOnChannel(CAGSTATUS_MESSAGE);
+    Outbound.requestMessageOnChannel(SAS_MODE_INFO_MESSAGE);
+
+    reconcileState = RECONCILE_WAITING_STATUS;
+    reconcileMismatch = 0;
+    reconcileStartTime = millis();
+    // Flips from before the switch belong to the old vessel
+    for (byte i = 0; i < RECONCILE_ITEM_COUNT; i++)
+    {
+        Input.clearEdge(RECONCILE_PINS[i]);
+    }
 
-        if (!shouldPrintSetMessage)
+    Outbound.printToKSP("Vessel change detected!", PRINT_TO_SCREEN);
+}
+
+/// <summary>Switch position the game currently expects for a reconcile item.</summary>
+ButtonState reconcileDesiredState(byte item)
+{
+    switch (item)
+    {
+    case RECONCILE_SAS:    return ag.isSAS ? ON : OFF;
+    case RECONCILE_RCS:    return ag.isRCS ? ON : OFF;
+    case RECONCILE_GEAR:   return !ag.isGear ? ON : OFF; // Switch ON = gear up
+    case RECONCILE_LIGHTS: return ag.isLights ? ON : OFF;
+    case RECONCILE_BRAKE:  return ag.isBrake ? ON : OFF;
+    default:               return OFF; // Docking, UI, Nav, View and Autopilot should be off
+    }
+}
+
+/// <summary>True while a switch conflicts with the game state and its control must be ignored.</summary>
+bool isReconcileLocked(byte virtualPin)
+{
+    if (reconcileState == RECONCILE_IDLE)
+        return false;
+
+    for (byte i = 0; i < RECONCILE_ITEM_COUNT; i++)
+    {
+        if (RECONCILE_PINS[i] != virtualPin)
+            continue;
+        // Until the game has reported its state every reconcile switch is held
+        if (reconcileState == RECONCILE_WAITING_STATUS)
+            return true;
+        return bitRead(reconcileMismatch, i);
+    }
+    return false;
+}
+
+/// <summary>Print every switch that still has to be corrected in one message.</summary>
+void printReconcileMismatches()
+{
+    String message = "Set";
+    for (byte i = 0; i < RECONCILE_ITEM_COUNT; i++)
+    {
+        if (!bitRead(reconcileMismatch, i))
+            continue;
+        message += " ";
+        message += RECONCILE_NAMES[i];
+        message += (reconcileDesiredState(i) == ON) ? " ON," : " OFF,";
+    }
+    // Drop trailing comma
+    message = message.substring(0, message.length() - 1);
+    Outbound.printToKSP(message, PRINT_TO_SCREEN);
+}
+
+/// <summary>Advance the vessel change reconciliation. Called every loop, never blocks.</summary>
+void updateVesselReconcile()
+{
+    // The kerbal's action groups say nothing about the switches, wait until back in a vessel
+    if (flightStatusMsg.isInEVA())
+        return;
+
+    switch (reconcileState)
+    {
+    case RECONCILE_IDLE:
+        return;
+
+    case RECONCILE_WAITING_STATUS:
+        if (!actionStatusReceived && millis() - reconcileStartTime < RECONCILE_STATUS_TIMEOUT)
+            return;
+
+        // Collect every mismatched switch at once
+        reconcileMismatch = 0;
+        for (byte i = 0; i < RECONCILE_ITEM_COUNT; i++)
         {
-            shouldPrintSetMessage = true;
+            if (Input.getVirtualPin(RECONCILE_PINS[i], false) != reconcileDesiredState(i))
+                bitSet(reconcileMismatch, i);
+            else
+            {
+                // Every switch was held while waiting, an edge left from then would toggle the
+                // game away from a switch that already matches
+                Input.clearEdge(RECONCILE_PINS[i]);
+            }
+        }
+        reconcileState = RECONCILE_PENDING;
+        if (reconcileMismatch != 0)
+        {
+            printReconcileMismatches();
+            reconcilePromptTimer.start(RECONCILE_PROMPT_INTERVAL);
         }
+        break;
+
+    case RECONCILE_PENDING:
+        for (byte i = 0; i < RECONCILE_ITEM_COUNT; i++)
+        {
+            if (!bitRead(reconcileMismatch, i))
+                continue;
+            if (Input.getVirtualPin(RECONCILE_PINS[i], false) == reconcileDesiredState(i))
+            {
+                // Swallow the edges so the now-matching switch does not send a command
+                Input.clearEdge(RECONCILE_PINS[i]);
+                bitClear(reconcileMismatch, i);
+                Outbound.printToKSP(String(RECONCILE_NAMES[i]) + " set.", PRINT_TO_SCREEN);
+            }
+        }
+        if (reconcileMismatch != 0 && reconcilePromptTimer.check())
+        {
+            printReconcileMismatches();
+        }
+        break;
     }
-    if (shouldPrintSetMessage)
+
+    if (reconcileState == RECONCILE_PENDING && reconcileMismatch == 0)
     {
-        mySimpit.printToKSP(switchName + " set.", PRINT_TO_SCREEN);
+        reconcileState = RECONCILE_IDLE;
+        Outbound.printToKSP("Inputs all set.", PRINT_TO_SCREEN);
+        keyboardEmulatorMessage pauseMsg(0x1B); // ESC key
+        Outbound.send(KEYBOARD_EMULATOR, pauseMsg);
     }
 }
+
 void refresh()
 {
     // Check flight status to determine which controls are active
@@ -703,23 +1186,13 @@ void refresh()
         setOXLEDs();
         setECLEDs();
         
-        // Update warning LEDs
-        setTempWarning();
-        setGeeWarning();
-        setGearWarning();
-        setWarpWarning();
-        setCommsWarning();
-        setAltWarning();
-        setPitchWarning();
+        // Warning LEDs and sounds, from the rules whose telemetry has updated
+        Warnings.update();
         
         refreshWarningButtons();// Numpad 0-9
 
         refreshRotationButton();
         
-
-        // Update audible warning based on above LED conditions
-        updateWarningSound();
-        
         // Update action group status LEDs (sync with game state)
         setActionGroupLEDs();
     }
@@ -742,8 +1215,8 @@ void refresh()
     if (inFlight)  // In flight or EVA
     {
         updateReferenceMode();
-        updateDirectionMode();
-        updateInfoMode();
+        bool directionModeChanged = updateDirectionMode();
+        bool infoModeChanged = updateInfoMode();
         
         // Update action group LEDs (always keep in sync with game state)
         setActionGroupLEDs();
@@ -758,70 +1231,42 @@ void refresh()
             setInfoLCD();
             setDirectionLCD();
         }
+        else
+        {
+            // Show a newly selected page straight away, from its cache if nothing it shows has changed
+            if (infoModeChanged)
+                setInfoLCD();
+            if (directionModeChanged)
+                setDirectionLCD();
+        }
 
         refreshGrab();  // EVA grab (F key)
         refreshBoard(); // EVA board (B key)
     }
 }
 
-// Choose and play a prioritized warning sound based on current telemetry
-void updateWarningSound()
-{
-    // Sound disabled for GEE, ALT (TERRAIN), and PITCH (PULL UP) warnings
-    // Only LEDs are used for these warnings
-    
-    // Other warnings still use sound
-    bool tempBlink = (tempLimitMsg.tempLimitPercentage >= HIGH_TEMP_WARNING_BLINKING_THRESHOLD);
-    bool tempSolid = (tempLimitMsg.tempLimitPercentage >= HIGH_TEMP_WARNING_SOLID_THRESHOLD);
-    bool commsLow = (flightStatusMsg.commNetSignalStrenghPercentage < COMMS_WARNING_THRESHOLD);
-
-    // Priority: TEMP, COMMS
-    if (tempBlink || tempSolid)
-    {
-        beepSound.beep(PATTERN_TEMP, sizeof(PATTERN_TEMP) / sizeof(int), true, 500);
-    }
-    else if (commsLow)
-    {
-        beepSound.beep(PATTERN_COMMS, sizeof(PATTERN_COMMS) / sizeof(int), true, 800);
-    }
-    else
-    {
-        // No warnings - stop beeping
-        beepSound.beep(nullptr, 0, false, 0);
-    }
-}
-
-
-
 /// <summary>Info from ksp.</summary>
 void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
 {
+    Link.onMessage(messageType);
     switch (messageType)
     {
     case LF_MESSAGE:
         if (msgSize == sizeof(resourceMessage)) {
             if (!lfReceived) {
-                // Print raw bytes
-                String rawData = "LF Raw bytes: ";
-                for (int i = 0; i < msgSize; i++) {
-                    if (msg[i] < 16) rawData += "0";
-                    rawData += String(msg[i], HEX) + " ";
-                }
-                printDebug(rawData);
-                
-                // Manual float decode to verify
-                float manualTotal, manualAvail;
-                memcpy(&manualTotal, &msg[0], 4);
-                memcpy(&manualAvail, &msg[4], 4);
-                printDebug("Manual decode: total=" + String(manualTotal, 2) + " avail=" + String(manualAvail, 2));
+                // Raw bytes as two words, decoded on dump
+                uint32_t rawTotal, rawAvail;
+                memcpy(&rawTotal, &msg[0], 4);
+                memcpy(&rawAvail, &msg[4], 4);
+                TRACE(TRACE_LF_RAW, rawTotal, rawAvail);
             }
             liquidFuelMsg = parseMessage<resourceMessage>(msg);
             if (!lfReceived) {
                 lfReceived = true;
-                printDebug("LF parsed: total=" + String(liquidFuelMsg.total, 2) + " avail=" + String(liquidFuelMsg.available, 2));
+                TRACE(TRACE_LF_PARSED, liquidFuelMsg.total, liquidFuelMsg.available);
             }
         } else {
-            printDebug("LF wrong size: got " + String(msgSize) + " expected " + String(sizeof(resourceMessage)));
+            TRACE(TRACE_LF_WRONG_SIZE, msgSize, sizeof(resourceMessage));
         }
         break;
     case LF_STAGE_MESSAGE:
@@ -833,7 +1278,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
             oxidizerMsg = parseMessage<resourceMessage>(msg);
             if (!oxReceived) {
                 oxReceived = true;
-                printDebug("OX data received: " + String(oxidizerMsg.available) + "/" + String(oxidizerMsg.total));
+                TRACE(TRACE_OX_RECEIVED, oxidizerMsg.available, oxidizerMsg.total);
             }
         }
         break;
@@ -846,7 +1291,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
             solidFuelMsg = parseMessage<resourceMessage>(msg);
             if (!sfReceived) {
                 sfReceived = true;
-                printDebug("SF data received: " + String(solidFuelMsg.available) + "/" + String(solidFuelMsg.total));
+                TRACE(TRACE_SF_RECEIVED, solidFuelMsg.available, solidFuelMsg.total);
             }
         }
         break;
@@ -867,7 +1312,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
             monopropellantMsg = parseMessage<resourceMessage>(msg);
             if (!mpReceived) {
                 mpReceived = true;
-                printDebug("MP data received: " + String(monopropellantMsg.available) + "/" + String(monopropellantMsg.total));
+                TRACE(TRACE_MP_RECEIVED, monopropellantMsg.available, monopropellantMsg.total);
             }
         }
         break;
@@ -881,7 +1326,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
             electricityMsg = parseMessage<resourceMessage>(msg);
             if (!ecReceived) {
                 ecReceived = true;
-                printDebug("EC data received: " + String(electricityMsg.available) + "/" + String(electricityMsg.total));
+                TRACE(TRACE_EC_RECEIVED, electricityMsg.available, electricityMsg.total);
             }
         }
         break;
@@ -924,7 +1369,13 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
         break;
     case MANEUVER_MESSAGE:
         if (msgSize == sizeof(maneuverMessage))
+        {
             maneuverMsg = parseManeuver(msg);
+            // Remember the node's full delta-v for the burn progress bar, a new or bigger node raises it
+            int32_t remaining = int_from_float_bits(maneuverMsg.deltaVNextManeuver, true);
+            if (remaining <= 0 || remaining > burnStartDeltaV)
+                burnStartDeltaV = remaining;
+        }
         break;
     case SAS_MODE_INFO_MESSAGE:
         if (msgSize == sizeof(SASInfoMessage))
@@ -942,6 +1393,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
         if (msgSize == 1)
         {
             byte current = msg[0];
+            actionStatusReceived = true;
 
             // Stage
             if (current & STAGE_ACTION)
@@ -1063,26 +1515,7 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
         if (msgSize == sizeof(flightStatusMessage))
         {
             flightStatusMsg = parseFlightStatusMessage(msg);
-            
-            // Detect vessel change (including initial vessel load)
-            bool isFirstLoad = (lastVesselType == 255 && lastCrewCount == 255);
-            bool vesselTypeChanged = (lastVesselType != 255 && flightStatusMsg.vesselType != lastVesselType);
-            bool crewCountChanged = (lastCrewCount != 255 && flightStatusMsg.crewCount != lastCrewCount);
-            
-            // Trigger vessel change on: initial load OR vessel type/crew changed
-            // Only trigger if connected and in flight
-            if (isConnectedToKSP && flightStatusMsg.isInFlight() && 
-                (isFirstLoad || vesselTypeChanged || crewCountChanged))
-            {
-                // Vessel changed! Pause the game
-                mySimpit.update();
-                vesselChange();
-            }
-            
-            // Update last known vessel properties
-            lastVesselStage = flightStatusMsg.currentStage;
-            lastVesselType = flightStatusMsg.vesselType;
-            lastCrewCount = flightStatusMsg.crewCount;
+            // Vessel changes are detected from the name and type in updateVesselIdentity()
         }
         break;
     case ATMO_CONDITIONS_MESSAGE:
@@ -1090,8 +1523,15 @@ void myCallbackHandler(byte messageType, byte msg[], byte msgSize)
         {
             atmoConditionsMsg = parseMessage<atmoConditionsMessage>(msg);
         }
+        break;
     case VESSEL_NAME_MESSAGE:
-
+        {
+            // Name bytes, not always terminated
+            int length = 0;
+            while (length < msgSize && msg[length] != 0) length++;
+            vesselNameHash = fnv1a(msg, length, FNV_OFFSET_BASIS);
+            vesselNameReceived = true;
+        }
         break;
     default:
         break;
@@ -1151,22 +1591,25 @@ void refreshMod()
     
     if (currentEnableState && !lastEnableState) // Button just pressed
     {
-        printDebug("Mod pressed - Right Shift down");
+        TRACE(TRACE_MOD_PRESSED);
         keyboardEmulatorMessage msgPress(0xA1, 1);  // Right Shift key - press
-        mySimpit.send(KEYBOARD_EMULATOR, msgPress);
+        Outbound.send(KEYBOARD_EMULATOR, msgPress);
     }
     else if (!currentEnableState && lastEnableState) // Button just released
     {
-        printDebug("Mod released - Right Shift up");
+        TRACE(TRACE_MOD_RELEASED);
         keyboardEmulatorMessage msgRelease(0xA1, 2);  // Right Shift key - release
-        mySimpit.send(KEYBOARD_EMULATOR, msgRelease);
+        Outbound.send(KEYBOARD_EMULATOR, msgRelease);
     }
     
     lastEnableState = currentEnableState;
 }
 
-void updateDirectionMode()
+/// <summary>Read the direction mode selector.</summary>
+/// <returns>True if the mode has changed.</returns>
+bool updateDirectionMode()
 {
+    byte lastMode = directionMode;
     // Array of direction mode VPINs (not sequential)
     const byte directionPins[12] = {
         VPIN_DIRECTION_MODE_1, VPIN_DIRECTION_MODE_2, VPIN_DIRECTION_MODE_3, VPIN_DIRECTION_MODE_4,
@@ -1184,10 +1627,14 @@ void updateDirectionMode()
             break;
         }
     }
+    return directionMode != lastMode;
 }
 
-void updateInfoMode()
+/// <summary>Read the info mode selector.</summary>
+/// <returns>True if the mode has changed.</returns>
+bool updateInfoMode()
 {
+    byte lastMode = infoMode;
     // Array of info mode VPINs (not sequential)
     const byte infoPins[12] = {
         VPIN_INFO_MODE_1, VPIN_INFO_MODE_2, VPIN_INFO_MODE_3, VPIN_INFO_MODE_4,
@@ -1205,13 +1652,14 @@ void updateInfoMode()
             break;
         }
     }
+    return infoMode != lastMode;
 }
 
 void updateReferenceMode()
 {
     if (Input.getVirtualPin(VPIN_REFERENCE_MODE_BUTTON) == ON)
     {
-        mySimpit.cycleNavBallMode();
+        Outbound.cycleNavBallMode();
         
         // Cycle through Surface -> Orbit -> Target
         switch (navballSpeedMode)
@@ -1240,131 +1688,163 @@ void refreshWarningButtons()
 {
     if (Input.getVirtualPin(VPIN_PITCH_WARNING_BUTTON) == ON)
     {
-        printDebug("PITCH warning cancel - Numpad 9");
+        TRACE(TRACE_PITCH_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x69);  // Numpad 9
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_ALT_WARNING_BUTTON) == ON)
     {
-        printDebug("ALT warning cancel - Numpad 8");
+        TRACE(TRACE_ALT_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x68); // Numpad 8
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_COMMS_WARNING_BUTTON) == ON)
     {
-        printDebug("COMMS warning cancel - Numpad 7");
+        TRACE(TRACE_COMMS_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x67); // Numpad 7
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_GEAR_WARNING_BUTTON) == ON)
     {
-        printDebug("GEAR warning cancel - Numpad 6");
+        TRACE(TRACE_GEAR_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x66);  // Numpad 6
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_RCS_WARNING_BUTTON) == ON)
     {
-        printDebug("RCS warning cancel - Numpad 5");
+        TRACE(TRACE_RCS_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x65);  // Numpad 5
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_SAS_WARNING_BUTTON) == ON)
     {
-        printDebug("SAS warning cancel - Numpad 4");
+        TRACE(TRACE_SAS_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x64);  // Numpad 4
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_BRAKE_WARNING_BUTTON) == ON)
     {
-        printDebug("BRAKE warning cancel - Numpad 3");
+        TRACE(TRACE_BRAKE_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x63);  // Numpad 3
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_WARP_WARNING_BUTTON) == ON)
     {
-        printDebug("WARP warning cancel - Numpad 2");
+        TRACE(TRACE_WARP_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x62);  // Numpad 2
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_GEE_WARNING_BUTTON) == ON)
     {
-        printDebug("GEE warning cancel - Numpad 1");
+        TRACE(TRACE_GEE_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x61);  // Numpad 1
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
     if (Input.getVirtualPin(VPIN_TEMP_WARNING_BUTTON) == ON)
     {
-        printDebug("TEMP warning cancel - Numpad 0");
+        TRACE(TRACE_TEMP_WARNING_CANCEL);
         keyboardEmulatorMessage msg(0x60);  // Numpad 0
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 
-void setTempWarning()
+// Values read by the warning rules, see WARNING_RULES
+fix16_t warnTempValue()
 {
-    // Check for overspeed condition too
-    float surfaceSpeed = velocityMsg.surface;
-    float radarAlt = altitudeMsg.surface;
-    bool isOverspeed = (surfaceSpeed > OVERSPEED_THRESHOLD && radarAlt < OVERSPEED_ALTITUDE_THRESHOLD);
-    
-    if (tempLimitMsg.tempLimitPercentage >= HIGH_TEMP_WARNING_BLINKING_THRESHOLD || isOverspeed)
-    {
-        // Blinking for extreme temperature or overspeed
-        Output.setLED(TEMP_WARNING_LED, (millis() / TEMP_WARNING_BLINK_INTERVAL) % 2);
-    }
-    else if (tempLimitMsg.tempLimitPercentage >= HIGH_TEMP_WARNING_SOLID_THRESHOLD)
-    {
-        // Solid for high temperature
-        Output.setLED(TEMP_WARNING_LED, true);
-    }
-    else
-    {
-        Output.setLED(TEMP_WARNING_LED, false);
-    }
+    return fix16_from_int(tempLimitMsg.tempLimitPercentage);
 }
-void setGeeWarning()
+fix16_t warnGeeValue()
 {
-    float gforce = airspeedMsg.gForces;
-    Output.setLED(GEE_WARNING_LED, gforce >= HIGH_GEE_WARNING_BLINKING_THRESHOLD ? (millis() / GEE_WARNING_BLINK_INTERVAL) % 2 : 
-                                   gforce >= HIGH_GEE_WARNING_SOLID_THRESHOLD);
+    return fix16_from_float_bits(airspeedMsg.gForces);
 }
-void setGearWarning()
+fix16_t warnOverspeedValue()
 {
-    float surfaceSpeed = velocityMsg.surface;
-    Output.setLED(GEAR_WARNING_LED, !ag.isGear ? false :
-                                    surfaceSpeed > GEAR_SPEED_WARNING_THRESHOLD ? (millis() / GEAR_WARNING_BLINK_INTERVAL) % 2 : true);
+    // Only counts low in the atmosphere
+    if (int_from_float_bits(altitudeMsg.surface) >= OVERSPEED_ALTITUDE_THRESHOLD)
+        return 0;
+    return fix16_from_float_bits(velocityMsg.surface);
 }
-void setWarpWarning()
+fix16_t warnGearDownValue()
 {
-    Output.setLED(WARP_WARNING_LED, flightStatusMsg.currentTWIndex > 1);
+    return ag.isGear ? FIX16_ONE : 0;
 }
-void setCommsWarning()
+fix16_t warnGearSpeedValue()
 {
-    Output.setLED(COMMS_WARNING_LED, flightStatusMsg.commNetSignalStrenghPercentage < COMMS_WARNING_THRESHOLD);
+    return ag.isGear ? fix16_from_float_bits(velocityMsg.surface) : 0;
 }
-void setAltWarning()
+fix16_t warnWarpValue()
 {
-    float surfaceAlt = max(0.0f, altitudeMsg.surface);
-    Output.setLED(ALT_WARNING_LED, !ag.isGear && surfaceAlt > 0.0f && surfaceAlt < LOW_ALTITUDE_WARNING_THRESHOLD);
+    return fix16_from_int(flightStatusMsg.currentTWIndex);
 }
-void setPitchWarning()
+fix16_t warnCommsValue()
 {
-    float verticalSpeed = velocityMsg.vertical;
-    float surfaceAlt = max(0.0f, altitudeMsg.surface);
-    
-    if (verticalSpeed >= 0 || ag.isGear || surfaceAlt <= 0.0f)
-    {
-        Output.setLED(PITCH_WARNING_LED, false);
-        return;
-    }
-
-    float timeToImpact = surfaceAlt / -verticalSpeed;
-    Output.setLED(PITCH_WARNING_LED, timeToImpact < TIME_TO_IMPACT_WARNING_THRESHOLD ? (millis() / PITCH_WARNING_BLINK_INTERVAL) % 2 : false);
+    return fix16_from_int(flightStatusMsg.commNetSignalStrenghPercentage);
+}
+fix16_t warnTerrainValue()
+{
+    int32_t surfaceAlt = int_from_float_bits(altitudeMsg.surface);
+    if (ag.isGear || surfaceAlt <= 0)
+        return FIX16_MAX;
+    return fix16_from_float_bits(altitudeMsg.surface);
+}
+fix16_t warnTimeToImpactValue()
+{
+    fix16_t verticalSpeed = fix16_from_float_bits(velocityMsg.vertical);
+    int32_t surfaceAlt = int_from_float_bits(altitudeMsg.surface);
+    if (verticalSpeed >= 0 || ag.isGear || surfaceAlt <= 0)
+        return FIX16_MAX;
+    // altitude / -speed, from Q32.32 so large altitudes do not saturate before the division
+    return fix16_saturate(((int64_t)surfaceAlt << 32) / -verticalSpeed);
+}
+fix16_t warnStallValue()
+{
+    if (ag.isGear)
+        return FIX16_MAX;
+    // Horizontal component only, a vertical descent is not a stall
+    return fix16_sqrt_diff_squares(fix16_from_float_bits(velocityMsg.surface), fix16_from_float_bits(velocityMsg.vertical));
 }
+
+// Rules that used to be one function per LED. Rules sharing an LED are arbitrated by priority.
+// Sound is kept to TEMP and COMMS as before; GEE, TERRAIN and PULL UP are LED only.
+const uint64_t WARN_SPEED_CHANNELS = WARNING_CHANNEL(VELOCITY_MESSAGE) | WARNING_CHANNEL(ALTITUDE_MESSAGE);
+const uint64_t WARN_GEAR_CHANNELS = WARNING_CHANNEL(ACTIONSTATUS_MESSAGE);
+const WarningRule WARNING_RULES[WARN_RULE_COUNT] = {
+    // channels, read, on, off, hold, led, pattern, period, sound, sound length, sound step, priority
+    { WARNING_CHANNEL(TEMP_LIMIT_MESSAGE), warnTempValue, HIGH_TEMP_WARNING_SOLID_THRESHOLD, HIGH_TEMP_WARNING_SOLID_CLEAR, WARNING_HOLD_TIME,
+        TEMP_WARNING_LED, LED_SOLID, 0, PATTERN_TEMP, sizeof(PATTERN_TEMP) / sizeof(int), 500, 30 },
+    { WARNING_CHANNEL(TEMP_LIMIT_MESSAGE), warnTempValue, HIGH_TEMP_WARNING_BLINKING_THRESHOLD, HIGH_TEMP_WARNING_BLINKING_CLEAR, WARNING_HOLD_TIME,
+        TEMP_WARNING_LED, LED_BLINK, 2 * TEMP_WARNING_BLINK_INTERVAL, nullptr, 0, 0, 70 },
+    { WARN_SPEED_CHANNELS, warnOverspeedValue, OVERSPEED_THRESHOLD, OVERSPEED_CLEAR, WARNING_HOLD_TIME,
+        TEMP_WARNING_LED, LED_BLINK, 2 * TEMP_WARNING_BLINK_INTERVAL, nullptr, 0, 0, 80 },
+    { WARNING_CHANNEL(AIRSPEED_MESSAGE), warnGeeValue, HIGH_GEE_WARNING_SOLID_THRESHOLD, HIGH_GEE_WARNING_SOLID_CLEAR, WARNING_HOLD_TIME,
+        GEE_WARNING_LED, LED_SOLID, 0, nullptr, 0, 0, 20 },
+    { WARNING_CHANNEL(AIRSPEED_MESSAGE), warnGeeValue, HIGH_GEE_WARNING_BLINKING_THRESHOLD, HIGH_GEE_WARNING_BLINKING_CLEAR, WARNING_HOLD_TIME,
+        GEE_WARNING_LED, LED_BLINK, 2 * GEE_WARNING_BLINK_INTERVAL, nullptr, 0, 0, 60 },
+    // Gear and warp are state lights, they follow the game without a hold
+    { WARN_GEAR_CHANNELS, warnGearDownValue, FIX16_ONE, FIX16_ONE, 0,
+        GEAR_WARNING_LED, LED_SOLID, 0, nullptr, 0, 0, 5 },
+    { WARN_GEAR_CHANNELS | WARNING_CHANNEL(VELOCITY_MESSAGE), warnGearSpeedValue, GEAR_SPEED_WARNING_THRESHOLD, GEAR_SPEED_WARNING_CLEAR, WARNING_HOLD_TIME,
+        GEAR_WARNING_LED, LED_BLINK, 2 * GEAR_WARNING_BLINK_INTERVAL, nullptr, 0, 0, 50 },
+    { WARNING_CHANNEL(FLIGHT_STATUS_MESSAGE), warnWarpValue, F16(2), F16(2), 0,
+        WARP_WARNING_LED, LED_SOLID, 0, nullptr, 0, 0, 10 },
+    { WARNING_CHANNEL(FLIGHT_STATUS_MESSAGE), warnCommsValue, COMMS_WARNING_THRESHOLD, COMMS_WARNING_CLEAR, WARNING_HOLD_TIME,
+        COMMS_WARNING_LED, LED_SOLID, 0, PATTERN_COMMS, sizeof(PATTERN_COMMS) / sizeof(int), 800, 20 },
+    { WARN_GEAR_CHANNELS | WARNING_CHANNEL(ALTITUDE_MESSAGE), warnTerrainValue, LOW_ALTITUDE_WARNING_THRESHOLD, LOW_ALTITUDE_WARNING_CLEAR, WARNING_HOLD_TIME,
+        ALT_WARNING_LED, LED_SOLID, 0, nullptr, 0, 0, 40 },
+    { WARN_GEAR_CHANNELS | WARN_SPEED_CHANNELS, warnTimeToImpactValue, TIME_TO_IMPACT_WARNING_THRESHOLD, TIME_TO_IMPACT_WARNING_CLEAR, WARNING_HOLD_TIME,
+        PITCH_WARNING_LED, LED_BLINK, 2 * PITCH_WARNING_BLINK_INTERVAL, nullptr, 0, 0, 90 },
+    // Shown on the speed LCD only
+    { WARN_GEAR_CHANNELS | WARNING_CHANNEL(VELOCITY_MESSAGE), warnStallValue, STALL_SPEED_THRESHOLD, STALL_SPEED_CLEAR, WARNING_HOLD_TIME,
+        WARNING_NO_LED, LED_OFF, 0, nullptr, 0, 0, 80 }
+};
+
 void setActionGroupLEDs()
 {
     Output.setLED(BRAKE_WARNING_LED, ag.isBrake);
-    Output.setLED(SAS_WARNING_LED, autopilotEnabled ? ((millis() / AUTOPILOT_LED_BLINK_INTERVAL) % 2) : ag.isSAS);
+    if (autopilotEnabled)
+        Output.setLEDPattern(SAS_WARNING_LED, LED_BLINK, 2 * AUTOPILOT_LED_BLINK_INTERVAL);
+    else
+        Output.setLED(SAS_WARNING_LED, ag.isSAS);
     Output.setLED(RCS_WARNING_LED, ag.isRCS);
 }
 
@@ -1489,8 +1969,8 @@ void refreshStage()
         Output.setLED(STAGE_LED, true);
         if (Input.getVirtualPin(VPIN_STAGE_BUTTON) == ON)
         {
-            printDebug("Stage button pressed");
-            mySimpit.activateAction(STAGE_ACTION);
+            TRACE(TRACE_STAGE);
+            Outbound.activateAction(STAGE_ACTION);
         }
     }
     else if (stageLock == OFF)
@@ -1506,8 +1986,8 @@ void refreshAbort()
         Output.setLED(ABORT_LED, true);
         if (Input.getVirtualPin(VPIN_ABORT_BUTTON) == ON)
         {
-            printDebug("Abort button pressed");
-            mySimpit.activateAction(ABORT_ACTION);
+            TRACE(TRACE_ABORT);
+            Outbound.activateAction(ABORT_ACTION);
         }
     }
     else if (abortLock == OFF)
@@ -1517,118 +1997,126 @@ void refreshAbort()
 }
 void refreshLights()
 {
+    if (isReconcileLocked(VPIN_LIGHTS_SWITCH))
+        return;
     switch (Input.getVirtualPin(VPIN_LIGHTS_SWITCH))
     {
     case NOT_READY:
         break;
     case ON:
-        printDebug("Lights ON");
-        mySimpit.activateAction(LIGHT_ACTION);
+        TRACE(TRACE_LIGHTS, true);
+        Outbound.activateAction(LIGHT_ACTION);
         break;
     case OFF:
-        printDebug("Lights OFF");
-        mySimpit.deactivateAction(LIGHT_ACTION);
+        TRACE(TRACE_LIGHTS, false);
+        Outbound.deactivateAction(LIGHT_ACTION);
         break;
     }
 }
 void refreshGear()
 {
+    if (isReconcileLocked(VPIN_GEAR_SWITCH))
+        return;
     switch (Input.getVirtualPin(VPIN_GEAR_SWITCH))
     {
     case NOT_READY:
         break;
     case ON:
-        printDebug("Gear UP");
-        mySimpit.deactivateAction(GEAR_ACTION);
+        TRACE(TRACE_GEAR_UP);
+        Outbound.deactivateAction(GEAR_ACTION);
         break;
     case OFF:
-        printDebug("Gear DOWN");
-        mySimpit.activateAction(GEAR_ACTION);
+        TRACE(TRACE_GEAR_DOWN);
+        Outbound.activateAction(GEAR_ACTION);
         break;
     }
 }
 void refreshBrake()
 {
+    if (isReconcileLocked(VPIN_BRAKE_SWITCH))
+        return;
     ButtonState val = Input.getVirtualPin(VPIN_BRAKE_SWITCH);
     switch (val)
     {
     case NOT_READY:
         break;
     case ON:
-        printDebug("Brakes ON");
-        mySimpit.activateAction(BRAKES_ACTION);
+        TRACE(TRACE_BRAKES, true);
+        Outbound.activateAction(BRAKES_ACTION);
         break;
     case OFF:
-        printDebug("Brakes OFF");
-        mySimpit.deactivateAction(BRAKES_ACTION);
+        TRACE(TRACE_BRAKES, false);
+        Outbound.deactivateAction(BRAKES_ACTION);
         break;
     }
 }
 void refreshDocking()
 {
+    if (isReconcileLocked(VPIN_DOCKING_SWITCH))
+        return;
     const bool DONT_CHANGE = true;
     ButtonState val = Input.getVirtualPin(VPIN_DOCKING_SWITCH, DONT_CHANGE);
     if (val == ON || val == OFF)
     {
         if (val == ON)
-            printDebug("Docking mode ON");
+            TRACE(TRACE_DOCKING_MODE, true);
         else
-            printDebug("Docking mode OFF");
+            TRACE(TRACE_DOCKING_MODE, false);
         
         keyboardEmulatorMessage msg(0x2E);  // Delete key (toggle docking mode)
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshCAGs()
 {
     if (Input.getVirtualPin(VPIN_CAG1) == ON)
     {
-        printDebug("CAG1 toggled");
-        mySimpit.toggleCAG(1);
+        TRACE(TRACE_CAG_TOGGLED, 1);
+        Outbound.toggleCAG(1);
     }
     if (Input.getVirtualPin(VPIN_CAG2) == ON)
     {
-        printDebug("CAG2 toggled");
-        mySimpit.toggleCAG(2);
+        TRACE(TRACE_CAG_TOGGLED, 2);
+        Outbound.toggleCAG(2);
     }
     if (Input.getVirtualPin(VPIN_CAG3) == ON)
     {
-        printDebug("CAG3 toggled");
-        mySimpit.toggleCAG(3);
+        TRACE(TRACE_CAG_TOGGLED, 3);
+        Outbound.toggleCAG(3);
     }
     if (Input.getVirtualPin(VPIN_CAG4) == ON)
     {
-        printDebug("CAG4 toggled");
-        mySimpit.toggleCAG(4);
+        TRACE(TRACE_CAG_TOGGLED, 4);
+        Outbound.toggleCAG(4);
     }
     if (Input.getVirtualPin(VPIN_CAG5) == ON)
     {
-        printDebug("CAG5 toggled");
-        mySimpit.toggleCAG(5);
+        TRACE(TRACE_CAG_TOGGLED, 5);
+        Outbound.toggleCAG(5);
     }
     if (Input.getVirtualPin(VPIN_CAG6) == ON)
     {
-        printDebug("CAG6 toggled");
-        mySimpit.toggleCAG(6);
+        TRACE(TRACE_CAG_TOGGLED, 6);
+        Outbound.toggleCAG(6);
     }
     if (Input.getVirtualPin(VPIN_CAG7) == ON)
     {
-        printDebug("CAG7 toggled");
-        mySimpit.toggleCAG(7);
+        TRACE(TRACE_CAG_TOGGLED, 7);
+        Outbound.toggleCAG(7);
     }    if (Input.getVirtualPin(VPIN_CAG8) == ON)
     {
-        printDebug("CAG8 toggled");
-        mySimpit.toggleCAG(8);
+        TRACE(TRACE_CAG_TOGGLED, 8);
+        Outbound.toggleCAG(8);
     }
     if (Input.getVirtualPin(VPIN_CAG9) == ON)
     {
-        printDebug("CAG9 toggled");
-        mySimpit.toggleCAG(9);
+        TRACE(TRACE_CAG_TOGGLED, 9);
+        Outbound.toggleCAG(9);
     }
     if (Input.getVirtualPin(VPIN_CAG10) == ON)
     {
-        printDebug("CAG10 toggled");
-        mySimpit.toggleCAG(10);
+        TRACE(TRACE_CAG_TOGGLED, 10);
+        Outbound.toggleCAG(10);
     }
 
 
@@ -1646,83 +2134,87 @@ void refreshCAGs()
 
 void refreshSAS()
 {
+    if (isReconcileLocked(VPIN_SAS_SWITCH))
+        return;
     ButtonState sasSwitch = Input.getVirtualPin(VPIN_SAS_SWITCH);
     if (sasSwitch == ON)
     {
-        printDebug("SAS ON");
-        mySimpit.activateAction(SAS_ACTION);
+        TRACE(TRACE_SAS, true);
+        Outbound.activateAction(SAS_ACTION);
     }
     else if (sasSwitch == OFF)
     {
-        printDebug("SAS OFF");
-        mySimpit.deactivateAction(SAS_ACTION);
+        TRACE(TRACE_SAS, false);
+        Outbound.deactivateAction(SAS_ACTION);
     }
 }
 void refreshRCS()
 {
+    if (isReconcileLocked(VPIN_RCS_SWITCH))
+        return;
     ButtonState rcsSwitch = Input.getVirtualPin(VPIN_RCS_SWITCH);
     if (rcsSwitch == ON)
     {
-        printDebug("RCS ON");
-        mySimpit.activateAction(RCS_ACTION);
+        TRACE(TRACE_RCS, true);
+        Outbound.activateAction(RCS_ACTION);
     }
     else if (rcsSwitch == OFF)
     {
-        printDebug("RCS OFF");
-        mySimpit.deactivateAction(RCS_ACTION);
+        TRACE(TRACE_RCS, false);
+        Outbound.deactivateAction(RCS_ACTION);
     }
 }
 void refreshAllSASModes()
 {
     if (Input.getVirtualPin(VPIN_SAS_STABILITY_ASSIST_BUTTON) == ON)
     {
-        printDebug("SAS: Stability Assist");
-        mySimpit.setSASMode(AP_STABILITYASSIST);
+        TRACE(TRACE_SAS_MODE, AP_STABILITYASSIST);
+        Outbound.setSASMode(AP_STABILITYASSIST);
     }
     if (Input.getVirtualPin(VPIN_SAS_MANEUVER_BUTTON) == ON)
     {
-        printDebug("SAS: Maneuver");
-        mySimpit.setSASMode(AP_MANEUVER);
+        TRACE(TRACE_SAS_MODE, AP_MANEUVER);
+        Outbound.setSASMode(AP_MANEUVER);
     }
     if (Input.getVirtualPin(VPIN_SAS_PROGRADE_BUTTON) == ON)
     {
-        printDebug("SAS: Prograde");
-        mySimpit.setSASMode(AP_PROGRADE);
+        TRACE(TRACE_SAS_MODE, AP_PROGRADE);
+        Outbound.setSASMode(AP_PROGRADE);
     }
     if (Input.getVirtualPin(VPIN_SAS_RETROGRADE_BUTTON) == ON)
     {
-        printDebug("SAS: Retrograde");
-        mySimpit.setSASMode(AP_RETROGRADE);
+        TRACE(TRACE_SAS_MODE, AP_RETROGRADE);
+        Outbound.setSASMode(AP_RETROGRADE);
     }
     if (Input.getVirtualPin(VPIN_SAS_NORMAL_BUTTON) == ON)
     {
-        printDebug("SAS: Normal");
-        mySimpit.setSASMode(AP_NORMAL);
+        TRACE(TRACE_SAS_MODE, AP_NORMAL);
+        Outbound.setSASMode(AP_NORMAL);
     }
     if (Input.getVirtualPin(VPIN_SAS_ANTI_NORMAL_BUTTON) == ON)
     {
-        printDebug("SAS: Anti-Normal");
-        mySimpit.setSASMode(AP_ANTINORMAL);
+        TRACE(TRACE_SAS_MODE, AP_ANTINORMAL);
+        Outbound.setSASMode(AP_ANTINORMAL);
     }
     if (Input.getVirtualPin(VPIN_SAS_RADIAL_IN_BUTTON) == ON)
     {
-        printDebug("SAS: Radial In");
-        mySimpit.setSASMode(AP_RADIALIN);
+        TRACE(TRACE_SAS_MODE, AP_RADIALIN);
+        Outbound.setSASMode(AP_RADIALIN);
     }
     if (Input.getVirtualPin(VPIN_SAS_RADIAL_OUT_BUTTON) == ON)
     {
-        printDebug("SAS: Radial Out");
-        mySimpit.setSASMode(AP_RADIALOUT);
+        TRACE(TRACE_SAS_MODE, AP_RADIALOUT);
+        Outbound.setSASMode(AP_RADIALOUT);
     }
     if (Input.getVirtualPin(VPIN_SAS_TARGET_BUTTON) == ON)
     {
-        printDebug("SAS: Target");
-        mySimpit.setSASMode(AP_TARGET);
+        TRACE(TRACE_SAS_MODE, AP_TARGET);
+        Outbound.setSASMode(AP_TARGET);
     }
     if (Input.getVirtualPin(VPIN_SAS_ANTI_TARGET_BUTTON) == ON)
     {
-        printDebug("SAS: Anti-Target");
-        mySimpit.setSASMode(AP_ANTITARGET);
+        TRACE(TRACE_SAS_MODE, AP_ANTITARGET);
+        Outbound.setSASMode(AP_ANTITARGET);
     }
 }
 
@@ -1730,54 +2222,58 @@ void refreshCamReset()
 {
     if (Input.getVirtualPin(VPIN_CAM_RESET_BUTTON) == ON)
     {
-        printDebug("Camera reset - backtick key");
+        TRACE(TRACE_CAMERA_RESET);
         keyboardEmulatorMessage msg(0xC0);  // Backtick key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshCamMode()
 {
     if (Input.getVirtualPin(VPIN_CAM_MODE_BUTTON) == ON)
     {
-        printDebug("Camera mode changed - V key");
+        TRACE(TRACE_CAMERA_MODE);
         keyboardEmulatorMessage msg(0x56); // V key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshFocus()
 {
     if (Input.getVirtualPin(VPIN_FOCUS_BUTTON) == ON)
     {
-        printDebug("Focus changed");
+        TRACE(TRACE_FOCUS_CHANGED);
         keyboardEmulatorMessage msg(0xDD);  // ] key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshView()
 {
+    if (isReconcileLocked(VPIN_VIEW_SWITCH))
+        return;
     if (Input.getVirtualPin(VPIN_VIEW_SWITCH) != NOT_READY) // Switch toggles in both states
     {
-        printDebug("Camera view cycled");
+        TRACE(TRACE_CAMERA_VIEW);
         keyboardEmulatorMessage msg(0x43);  // C key (toggle camera view)
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshNav()
 {
+    if (isReconcileLocked(VPIN_NAV_SWITCH))
+        return;
     if (Input.getVirtualPin(VPIN_NAV_SWITCH) != NOT_READY) // Switch toggles in both states
     {
-        printDebug("Map Toggled");
+        TRACE(TRACE_MAP_TOGGLED);
         keyboardEmulatorMessage msg(0x4D);  // M key (toggle map view)
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshUI()
 {
     if (Input.getVirtualPin(VPIN_UI_BUTTON) == ON)
     {
-        printDebug("UI Toggled");
+        TRACE(TRACE_UI_TOGGLED);
         keyboardEmulatorMessage msg(0x71);  // F2
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 
@@ -1785,14 +2281,16 @@ void refreshSoundSwitch()
 {
     if (Input.getVirtualPin(VPIN_SOUND_SWITCH) != NOT_READY)
     {
-        printDebug("Sound switch toggled");
+        TRACE(TRACE_SOUND_SWITCH);
         keyboardEmulatorMessage msg(0xDE);  // VK_OEM_7 = single/double quote key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 
 void refreshAP()
 {
+    if (isReconcileLocked(VPIN_AUTO_PILOT_SWITCH))
+        return;
     // Repurpose the physical-warp switch as an AUTOPILOT toggle.
     auto ap = Input.getVirtualPin(VPIN_AUTO_PILOT_SWITCH, true);
     if (ap == ON)
@@ -1802,21 +2300,21 @@ void refreshAP()
         {
             // Capture current telemetry as the hold targets
             // Use prograde (velocity) heading for more stable flight - less sensitive to vessel oscillations
-            autopilotHeading = vesselPointingMsg.surfaceVelocityHeading;
-            autopilotSpeed = velocityMsg.surface;
-            autopilotAltitude = altitudeMsg.sealevel;
+            autopilotHeading = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityHeading);
+            autopilotSpeed = fix16_from_float_bits(velocityMsg.surface);
+            autopilotAltitude = fix16_from_float_bits(altitudeMsg.sealevel);
             autopilotEngageTime = millis();
             autopilotEnabled = true;
 
             // Save current SAS state and enable SAS for autopilot
             sasWasOnBeforeAutopilot = ag.isSAS;
-            mySimpit.activateAction(SAS_ACTION);
+            Outbound.activateAction(SAS_ACTION);
 
-            mySimpit.printToKSP("Autopilot Engaged", PRINT_TO_SCREEN);
+            Outbound.printToKSP("Autopilot Engaged", PRINT_TO_SCREEN);
         }
         else
         {
-            printDebug("Cannot engage autopilot");
+            TRACE(TRACE_AUTOPILOT_REFUSED);
         }
     }
     else if (ap == OFF)
@@ -1826,10 +2324,10 @@ void refreshAP()
             autopilotEnabled = false;
             
             // Restore SAS to its previous state
-            sasWasOnBeforeAutopilot ? mySimpit.activateAction(SAS_ACTION) : mySimpit.deactivateAction(SAS_ACTION);
+            sasWasOnBeforeAutopilot ? Outbound.activateAction(SAS_ACTION) : Outbound.deactivateAction(SAS_ACTION);
             
-            mySimpit.printToKSP("Autopilot DISENGAGED", PRINT_TO_SCREEN);
-            printDebug("Autopilot disengaged");
+            Outbound.printToKSP("Autopilot DISENGAGED", PRINT_TO_SCREEN);
+            TRACE(TRACE_AUTOPILOT_DISENGAGED);
         }
     }
 }
@@ -1842,14 +2340,14 @@ void refreshWarp()
     if (Input.getVirtualPin(VPIN_WARP_LOCK_SWITCH) == OFF)
     {
         twMsg.command = TIMEWARP_X1;
-        mySimpit.send(TIMEWARP_MESSAGE, twMsg);
+        Outbound.send(TIMEWARP_MESSAGE, twMsg);
     }
     // Cancel warp button, always allowed
     if (Input.getVirtualPin(VPIN_CANCEL_WARP_BUTTON) == ON)
     {
-        printDebug("Warp cancelled");
+        TRACE(TRACE_WARP_CANCELLED);
         twMsg.command = TIMEWARP_X1;
-        mySimpit.send(TIMEWARP_MESSAGE, twMsg);
+        Outbound.send(TIMEWARP_MESSAGE, twMsg);
         return;
     }
 
@@ -1861,24 +2359,24 @@ void refreshWarp()
 
     if (Input.getVirtualPin(VPIN_INCREASE_WARP_BUTTON) == ON) 
     {
-        printDebug("Warp increased");
+        TRACE(TRACE_WARP_INCREASED);
         twMsg.command = TIMEWARP_UP;
-        mySimpit.send(TIMEWARP_MESSAGE, twMsg);
+        Outbound.send(TIMEWARP_MESSAGE, twMsg);
     } 
     if (Input.getVirtualPin(VPIN_DECREASE_WARP_BUTTON) == ON) 
     {
-        printDebug("Warp decreased");
+        TRACE(TRACE_WARP_DECREASED);
         twMsg.command = TIMEWARP_DOWN;
-        mySimpit.send(TIMEWARP_MESSAGE, twMsg);
+        Outbound.send(TIMEWARP_MESSAGE, twMsg);
     }
 }
 void refreshPause()
 {
     if (Input.getVirtualPin(VPIN_PAUSE_BUTTON) == ON)
     {
-        printDebug("Pause toggled");
+        TRACE(TRACE_PAUSE_TOGGLED);
         keyboardEmulatorMessage msg(0x1B);  // ESC key (toggle pause)
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 
@@ -1939,19 +2437,19 @@ void refreshRotationButton()
 {
     if (Input.getVirtualPin(VPIN_ROTATION_BUTTON) == ON)
     {
-        printDebug("Rotation button - HOME key");
+        TRACE(TRACE_ROTATION_BUTTON_HOME);
         keyboardEmulatorMessage msg(0x24);  // HOME key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshJump()
 {
     if (Input.getVirtualPin(VPIN_ROTATION_BUTTON) == ON)
     {
-        printDebug("Rotation button - SPACE key");
+        TRACE(TRACE_ROTATION_BUTTON_SPACE);
         
         keyboardEmulatorMessage msg(0x20);  // Space key
-        mySimpit.send(KEYBOARD_EMULATOR, msg);
+        Outbound.send(KEYBOARD_EMULATOR, msg);
     }
 }
 void refreshGrab()
@@ -1965,10 +2463,10 @@ void refreshGrab()
         if (inEVA)
         {
             // EVA Grab using F key (VK code 0x46)
-            printDebug("EVA Grab");
+            TRACE(TRACE_EVA_GRAB);
             
             keyboardEmulatorMessage msg(0x46);  // F key (EVA grab)
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (inFlight && !inEVA)
         {
@@ -1977,8 +2475,8 @@ void refreshGrab()
             if (precisionModifier < MIN_PRECISION_MODIFIER)
                 precisionModifier = MIN_PRECISION_MODIFIER;
             
-            mySimpit.printToKSP("Precision: " + String((int)(precisionModifier * 100)) + "%", PRINT_TO_SCREEN);
-            printDebug("Precision decreased to " + String((int)(precisionModifier * 100)) + "%");
+            Outbound.printToKSP("Precision: " + String((int)(precisionModifier * 100)) + "%", PRINT_TO_SCREEN);
+            TRACE(TRACE_PRECISION, (int)(precisionModifier * 100));
         }
     }
     
@@ -1995,10 +2493,10 @@ void refreshBoard()
         if (inEVA)
         {
             // EVA Board using B key (VK code 0x42)
-            printDebug("EVA Board");
+            TRACE(TRACE_EVA_BOARD);
             
             keyboardEmulatorMessage msg(0x42);  // B key (EVA board)
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (inFlight && !inEVA)
         {
@@ -2007,8 +2505,8 @@ void refreshBoard()
             if (precisionModifier > MAX_PRECISION_MODIFIER)
                 precisionModifier = MAX_PRECISION_MODIFIER;
             
-            mySimpit.printToKSP("Precision: " + String((int)(precisionModifier * 100)) + "%", PRINT_TO_SCREEN);
-            printDebug("Precision increased to " + String((int)(precisionModifier * 100)) + "%");
+            Outbound.printToKSP("Precision: " + String((int)(precisionModifier * 100)) + "%", PRINT_TO_SCREEN);
+            TRACE(TRACE_PRECISION, (int)(precisionModifier * 100));
         }
     }
 }
@@ -2025,34 +2523,33 @@ void refreshThrottle()
         // Altitude is controlled by pitch offset (1° up/down to adjust prograde)
         if (isConnectedToKSP)
         {
-            float currentSpeed = velocityMsg.surface;
-            float speedError = autopilotSpeed - currentSpeed; // m/s (positive = need more speed)
+            fix16_t currentSpeed = fix16_from_float_bits(velocityMsg.surface);
+            fix16_t speedError = fix16_sub(autopilotSpeed, currentSpeed); // m/s (positive = need more speed)
 
             // Determine whether altitude or heading need priority. If so, avoid aggressive speed matching.
-            float currentAlt = altitudeMsg.sealevel;
-            float altErr = autopilotAltitude - currentAlt; // meters
-            float currentHeading = vesselPointingMsg.surfaceVelocityHeading;
-            float hdgErr = shortestAngleDiff(autopilotHeading, currentHeading);
+            fix16_t currentAlt = fix16_from_float_bits(altitudeMsg.sealevel);
+            fix16_t altErr = fix16_sub(autopilotAltitude, currentAlt); // meters
+            fix16_t currentHeading = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityHeading);
+            fix16_t hdgErr = shortestAngleDiff(autopilotHeading, currentHeading);
 
             // Dynamic base throttle that adapts to find equilibrium
-            static float baseThrottle = 0.5; // Start at 50%
+            static fix16_t baseThrottle = F16(0.5); // Start at 50%
             
             // Adapt base throttle continuously when stable
-            if (abs(speedError) < 10.0 && abs(altErr) <= AUTOPILOT_ALT_PRIORITY_THRESHOLD && abs(hdgErr) <= AUTOPILOT_HEADING_PRIORITY_THRESHOLD)
+            if (fix16_abs(speedError) < F16(10.0) && fix16_abs(altErr) <= AUTOPILOT_ALT_PRIORITY_THRESHOLD && fix16_abs(hdgErr) <= AUTOPILOT_HEADING_PRIORITY_THRESHOLD)
             {
                 // Continuously adjust base throttle based on speed error
-                if (speedError > 0.5) {
+                if (speedError > F16(0.5)) {
                     baseThrottle += AP_THROTTLE_ADAPT_RATE; // Need more throttle
-                } else if (speedError < -0.5) {
+                } else if (speedError < -F16(0.5)) {
                     baseThrottle -= AP_THROTTLE_ADAPT_RATE; // Need less throttle
                 }
                 // Allow full range for base throttle
-                if (baseThrottle < 0.0) baseThrottle = 0.0;
-                if (baseThrottle > 1.0) baseThrottle = 1.0;
+                baseThrottle = fix16_clamp(baseThrottle, 0, FIX16_ONE);
             }
 
-            float throttleFraction;
-            if (abs(altErr) > AUTOPILOT_ALT_PRIORITY_THRESHOLD || abs(hdgErr) > AUTOPILOT_HEADING_PRIORITY_THRESHOLD)
+            fix16_t throttleFraction;
+            if (fix16_abs(altErr) > AUTOPILOT_ALT_PRIORITY_THRESHOLD || fix16_abs(hdgErr) > AUTOPILOT_HEADING_PRIORITY_THRESHOLD)
             {
                 // Prioritize altitude/heading: keep base throttle
                 throttleFraction = baseThrottle;
@@ -2060,23 +2557,22 @@ void refreshThrottle()
             else
             {
                 // Base throttle + aggressive speed correction using full range
-                throttleFraction = baseThrottle + (AP_SPEED_K * speedError);
+                throttleFraction = fix16_add(baseThrottle, fix16_mul(AP_SPEED_K, speedError));
             }
 
             // Allow full throttle range from 0 to 1
-            if (throttleFraction < 0.0f) throttleFraction = 0.0f;
-            if (throttleFraction > 1.0f) throttleFraction = 1.0f;
+            throttleFraction = fix16_clamp(throttleFraction, 0, FIX16_ONE);
 
             // Smooth throttle changes to avoid abrupt commands
-            static float lastThrottleFraction = 0.3;
-            float alpha = THROTTLE_SMOOTH_ALPHA;
-            float smoothed = lastThrottleFraction * (1.0f - alpha) + throttleFraction * alpha;
+            static fix16_t lastThrottleFraction = F16(0.3);
+            fix16_t smoothed = fix16_lerp(lastThrottleFraction, throttleFraction, throttleSmoothAlpha);
             lastThrottleFraction = smoothed;
 
-            int16_t apThrottle = (int16_t)(smoothed * (float)INT16_MAX);
+            int16_t apThrottle = fix16_to_axis(smoothed);
             throttleMessage throttleMsg;
             throttleMsg.throttle = apThrottle;
-            mySimpit.send(THROTTLE_MESSAGE, throttleMsg);
+            Outbound.sendAxis(THROTTLE_MESSAGE, throttleMsg);
+            sentThrottle = apThrottle;
         }
         // Block manual throttle while autopilot holds
         return;
@@ -2111,7 +2607,8 @@ void refreshThrottle()
         
         throttleMessage throttleMsg;
         throttleMsg.throttle = lastThrottle;
-        if (isConnectedToKSP) mySimpit.send(THROTTLE_MESSAGE, throttleMsg);
+        if (isConnectedToKSP) Outbound.sendAxis(THROTTLE_MESSAGE, throttleMsg);
+        sentThrottle = lastThrottle;
     }
     // If lock is OFF, don't send any throttle updates (holds current position in KSP)
     
@@ -2126,7 +2623,7 @@ void refreshTranslation()
     if (btnState == ON)
     {
         viewModeEnabled = !viewModeEnabled;
-        printDebug(viewModeEnabled ? "View mode ENABLED" : "View mode DISABLED");
+        TRACE(TRACE_VIEW_MODE, viewModeEnabled);
     }
     
     // If view mode is enabled, use joystick for camera control
@@ -2142,24 +2639,24 @@ void refreshTranslation()
         if (x < (512 - CAMERA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x25); // Left
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (x > (512 + CAMERA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x27); // Right
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
 
         // Y-axis: Up/Down camera (INVERTED - forward = look up, back = look down)
         if (y < (512 - CAMERA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x26); // Up
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (y > (512 + CAMERA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x28); // Down
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
 
         // Z-axis: Zoom in/out using mouse wheel emulation
@@ -2168,13 +2665,13 @@ void refreshTranslation()
         {
             // Zoom out (Mouse wheel down) - joystick pulled back/down
             keyboardEmulatorMessage msg(0xFF02);  // Mouse wheel down
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (z > (512 + CAMERA_DEADZONE))
         {
             // Zoom in (Mouse wheel up) - joystick pushed forward/up
             keyboardEmulatorMessage msg(0xFF01);  // Mouse wheel up
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
 
         return;
@@ -2221,7 +2718,7 @@ void refreshTranslation()
         trimTransY = (tempY > INT16_MAX) ? INT16_MAX : ((tempY < INT16_MIN) ? INT16_MIN : (int16_t)tempY);
         trimTransZ = (tempZ > INT16_MAX) ? INT16_MAX : ((tempZ < INT16_MIN) ? INT16_MIN : (int16_t)tempZ);
         
-        printDebug("Translation TRIM adjusted");
+        TRACE(TRACE_TRANSLATION_TRIM);
     }
     lastTransTrimState = currentTransTrimState;
     
@@ -2234,7 +2731,7 @@ void refreshTranslation()
         trimTransX = 0;
         trimTransY = 0;
         trimTransZ = 0;
-        printDebug("Translation TRIM reset");
+        TRACE(TRACE_TRANSLATION_TRIM_RESET);
     }
     lastTransResetState = currentTransResetState;
 
@@ -2256,15 +2753,15 @@ void refreshTranslation()
             // Restore SAS to its previous state
             if (sasWasOnBeforeAutopilot)
             {
-                mySimpit.activateAction(SAS_ACTION);
+                Outbound.activateAction(SAS_ACTION);
             }
             else
             {
-                mySimpit.deactivateAction(SAS_ACTION);
+                Outbound.deactivateAction(SAS_ACTION);
             }
             
-            mySimpit.printToKSP("Autopilot DISENGAGED (joystick override)", PRINT_TO_SCREEN);
-            printDebug("Autopilot cancelled by translation joystick override");
+            Outbound.printToKSP("Autopilot DISENGAGED (joystick override)", PRINT_TO_SCREEN);
+            TRACE(TRACE_AUTOPILOT_OVERRIDE, 0);
         }
         else
         {
@@ -2313,12 +2810,12 @@ void refreshTranslation()
 
     // In shared control mode, translation joystick is used for rotation - don't send translation message
     // UNLESS view mode is enabled (camera controls take priority over dual player mode)
-    if (Input.getVirtualPin(VPIN_DUAL_SWITCH, false) == ON)
+    if (Input.getVirtualPin(VPIN_DUAL_SWITCH, false) == ON && !isReconcileLocked(VPIN_DUAL_SWITCH))
         return;
 
     translationMessage transMsg;
     transMsg.setXYZ(transX, transZ, transY);
-    if (isConnectedToKSP) mySimpit.send(TRANSLATION_MESSAGE, transMsg);
+    if (isConnectedToKSP) Outbound.sendAxis(TRANSLATION_MESSAGE, transMsg);
 }
 
 bool handleAutopilotRotation()
@@ -2342,15 +2839,15 @@ bool handleAutopilotRotation()
         // Restore SAS to its previous state
         if (sasWasOnBeforeAutopilot)
         {
-            mySimpit.activateAction(SAS_ACTION);
+            Outbound.activateAction(SAS_ACTION);
         }
         else
         {
-            mySimpit.deactivateAction(SAS_ACTION);
+            Outbound.deactivateAction(SAS_ACTION);
         }
         
-        mySimpit.printToKSP("Autopilot DISENGAGED (joystick override)", PRINT_TO_SCREEN);
-        printDebug("Autopilot cancelled by rotation joystick override");
+        Outbound.printToKSP("Autopilot DISENGAGED (joystick override)", PRINT_TO_SCREEN);
+        TRACE(TRACE_AUTOPILOT_OVERRIDE, 1);
         return false;
     }
     
@@ -2358,63 +2855,55 @@ bool handleAutopilotRotation()
     if (isConnectedToKSP)
     {
         // Heading control (yaw) - use prograde (velocity) heading for stability
-        float currentHeading = vesselPointingMsg.surfaceVelocityHeading;
-        float hdgErr = shortestAngleDiff(autopilotHeading, currentHeading);
+        fix16_t currentHeading = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityHeading);
+        fix16_t hdgErr = shortestAngleDiff(autopilotHeading, currentHeading);
         
-        float yawFrac = 0.0f;
-        if (abs(hdgErr) > 2.0f)
+        fix16_t yawFrac = 0;
+        if (fix16_abs(hdgErr) > F16(2.0))
         {
-            yawFrac = hdgErr * AP_HEADING_K;
-            if (yawFrac > 1.0f) yawFrac = 1.0f;
-            if (yawFrac < -1.0f) yawFrac = -1.0f;
+            yawFrac = fix16_clamp(fix16_mul(hdgErr, AP_HEADING_K), -FIX16_ONE, FIX16_ONE);
         }
-        int16_t yawVal = (int16_t)(yawFrac * (float)INT16_MAX);
+        int16_t yawVal = fix16_to_axis(yawFrac);
 
         // Pitch control: Monitor prograde pitch and adjust vessel pitch to correct it
-        float progradePitch = vesselPointingMsg.surfaceVelocityPitch;
-        float currentAlt = altitudeMsg.sealevel;
-        float altErr = autopilotAltitude - currentAlt;
+        fix16_t progradePitch = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityPitch);
+        fix16_t currentAlt = fix16_from_float_bits(altitudeMsg.sealevel);
+        fix16_t altErr = fix16_sub(autopilotAltitude, currentAlt);
 
         // Determine target prograde pitch based on altitude error
-        float targetProgradePitch = 0.0f;
-        if (abs(altErr) > 8.0f)
+        fix16_t targetProgradePitch = 0;
+        if (fix16_abs(altErr) > F16(8.0))
         {
-            float pitchOffset = altErr / 15.0f;
-            if (pitchOffset > 12.0f) pitchOffset = 12.0f;
-            if (pitchOffset < -12.0f) pitchOffset = -12.0f;
-            targetProgradePitch = pitchOffset;
+            targetProgradePitch = fix16_clamp(altErr / 15, -F16(12.0), F16(12.0));
         }
         
-        float progradeErr = targetProgradePitch - progradePitch;
+        fix16_t progradeErr = fix16_sub(targetProgradePitch, progradePitch);
         
-        float pitchFrac = 0.0f;
-        if (abs(progradeErr) > 0.3f)
+        fix16_t pitchFrac = 0;
+        if (fix16_abs(progradeErr) > F16(0.3))
         {
-            float gain = (abs(progradeErr) > 2.0f) ? 0.08 : 0.05;
-            pitchFrac = progradeErr * gain;
-            float maxFrac = (abs(progradeErr) > 2.0f) ? 0.35f : 0.20f;
-            if (pitchFrac > maxFrac) pitchFrac = maxFrac;
-            if (pitchFrac < -maxFrac) pitchFrac = -maxFrac;
+            bool largeError = fix16_abs(progradeErr) > F16(2.0);
+            fix16_t gain = largeError ? F16(0.08) : F16(0.05);
+            fix16_t maxFrac = largeError ? F16(0.35) : F16(0.20);
+            pitchFrac = fix16_clamp(fix16_mul(progradeErr, gain), -maxFrac, maxFrac);
         }
-        int16_t pitchVal = (int16_t)(pitchFrac * (float)INT16_MAX);
+        int16_t pitchVal = fix16_to_axis(pitchFrac);
 
         // Roll hold: keep roll at zero (level wings)
-        float currentRoll = vesselPointingMsg.roll;
-        float rollErr = shortestAngleDiff(0.0f, currentRoll);
+        fix16_t currentRoll = fix16_from_float_bits(vesselPointingMsg.roll);
+        fix16_t rollErr = shortestAngleDiff(0, currentRoll);
         
-        float rollFrac = 0.0f;
-        if (abs(rollErr) > 1.0f)
+        fix16_t rollFrac = 0;
+        if (fix16_abs(rollErr) > F16(1.0))
         {
-            rollFrac = rollErr * AP_ROLL_K;
-            if (rollFrac > 1.0f) rollFrac = 1.0f;
-            if (rollFrac < -1.0f) rollFrac = -1.0f;
+            rollFrac = fix16_clamp(fix16_mul(rollErr, AP_ROLL_K), -FIX16_ONE, FIX16_ONE);
         }
-        int16_t rollVal = (int16_t)(-rollFrac * (float)INT16_MAX);
+        int16_t rollVal = fix16_to_axis(-rollFrac);
 
         // Compose and send rotation
         rotationMessage rotMsg;
         rotMsg.setPitchRollYaw(pitchVal, rollVal, yawVal);
-        mySimpit.send(ROTATION_MESSAGE, rotMsg);
+        Outbound.sendAxis(ROTATION_MESSAGE, rotMsg);
     }
     
     return true;
@@ -2433,23 +2922,23 @@ void refreshRotation()
         if (x < (512 - EVA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x41); // A Key
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (x > (512 + EVA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x44); // D Key
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         
         if (y < (512 - EVA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x57); // W Key
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         else if (y > (512 + EVA_DEADZONE))
         {
             keyboardEmulatorMessage msg(0x53); // S Key
-            mySimpit.send(KEYBOARD_EMULATOR, msg);
+            Outbound.send(KEYBOARD_EMULATOR, msg);
         }
         
         return; // EVA so exit
@@ -2494,7 +2983,7 @@ void refreshRotation()
         trimRotY = (tempY > INT16_MAX) ? INT16_MAX : ((tempY < INT16_MIN) ? INT16_MIN : (int16_t)tempY);
         trimRotZ = (tempZ > INT16_MAX) ? INT16_MAX : ((tempZ < INT16_MIN) ? INT16_MIN : (int16_t)tempZ);
         
-        printDebug("Rotation TRIM adjusted");
+        TRACE(TRACE_ROTATION_TRIM);
     }
     lastRotTrimState = currentRotTrimState;
     
@@ -2507,7 +2996,7 @@ void refreshRotation()
         trimRotX = 0;
         trimRotY = 0;
         trimRotZ = 0;
-        printDebug("Rotation TRIM reset");
+        TRACE(TRACE_ROTATION_TRIM_RESET);
     }
     lastRotResetState = currentRotResetState;
         
@@ -2518,7 +3007,8 @@ void refreshRotation()
     // Continue with normal operation below
     
     // Check if shared control mode is enabled (UI switch)
-    bool sharedControlMode = (Input.getVirtualPin(VPIN_DUAL_SWITCH, false) == ON && !viewModeEnabled);
+    bool sharedControlMode = (Input.getVirtualPin(VPIN_DUAL_SWITCH, false) == ON && !viewModeEnabled &&
+                              !isReconcileLocked(VPIN_DUAL_SWITCH));
     
     // Read rotation joystick (Player 1)
     int x = Input.getRotationXAxis();
@@ -2589,8 +3079,8 @@ void refreshRotation()
     // Send wheel steering directly
     wheelMsg.setSteer(smoothAndMapAxis(z, true)); // Negate to match expected direction
     if (isConnectedToKSP) {
-        mySimpit.send(ROTATION_MESSAGE, rotMsg);
-        mySimpit.send(WHEEL_MESSAGE, wheelMsg);
+        Outbound.sendAxis(ROTATION_MESSAGE, rotMsg);
+        Outbound.sendAxis(WHEEL_MESSAGE, wheelMsg);
     }
 }
 
@@ -2603,19 +3093,10 @@ void setSpeedLCD()
     String topTxt = "";
     String botTxt = "";
     
-    // Check for overspeed and stall warnings
-    float surfaceSpeed = velocityMsg.surface;
-    float radarAlt = altitudeMsg.surface;
-    bool isOverspeed = (surfaceSpeed > 900.0 && radarAlt < 15000.0); // Match mod: 900 m/s, 15km altitude
-    
-    // Stall warning: only when under 100 mph (44.7 m/s) AND gear is up
-    // Subtract vertical velocity to get horizontal component (ignore vertical descent)
-    const float STALL_SPEED_MPH = 100.0;
-    const float STALL_SPEED_MS = STALL_SPEED_MPH * 0.44704; // 44.7 m/s
-    bool gearUp = !ag.isGear;
-    float vertSpeed = velocityMsg.vertical;
-    float horizontalSpeed = sqrt(max(0.0f, surfaceSpeed * surfaceSpeed - vertSpeed * vertSpeed));
-    bool isStall = (gearUp && horizontalSpeed < STALL_SPEED_MS);
+    // Overspeed and stall come from the warning rules
+    bool isOverspeed = Warnings.isActive(WARN_OVERSPEED);
+    bool isStall = Warnings.isActive(WARN_STALL);
+    fix16_t vertSpeed = fix16_from_float_bits(velocityMsg.vertical);
     
     // Blink the display if overspeed or stall warning is active
     bool blinkState = (millis() / 500) % 2; // Blink every 500ms
@@ -2669,6 +3150,11 @@ void setSpeedLCD()
 
     // Bottom line: Always show vertical velocity - only change units if won't fit
     verticalSpeed = velocityMsg.vertical;
+    // Arrow for climbing or descending
+    String vertLabel = "VRT-SPD";
+    if (vertSpeed >= F16(0.5)) vertLabel += Output.glyphChar(GLYPH_ARROW_UP);
+    else if (vertSpeed <= -F16(0.5)) vertLabel += Output.glyphChar(GLYPH_ARROW_DOWN);
+    else vertLabel += " ";
     String vertUnit = "m/s";
     if (useImperialUnits) {
         // Use mph for vertical/horizontal consistency
@@ -2678,10 +3164,10 @@ void setSpeedLCD()
         if (abs(verticalSpeed) >= 99999.0) {
             verticalSpeed /= 3600.0; // Convert mph to mi/s
             vertUnit = "mi/s";
-            botTxt += "VRT-SPD ";
+            botTxt += vertLabel;
             botTxt += formatNumber(verticalSpeed, 4, true, false);
         } else {
-            botTxt += "VRT-SPD ";
+            botTxt += vertLabel;
             botTxt += formatNumber(verticalSpeed, 5, true, false);
         }
     } else {
@@ -2689,10 +3175,10 @@ void setSpeedLCD()
         if (abs(verticalSpeed) >= 9999.0) {
             verticalSpeed /= 1000.0; // Convert m/s to km/s
             vertUnit = "km/s";
-            botTxt += "VRT-SPD ";
+            botTxt += vertLabel;
             botTxt += formatNumber(verticalSpeed, 4, true, false);
         } else {
-            botTxt += "VRT-SPD ";
+            botTxt += vertLabel;
             botTxt += formatNumber(verticalSpeed, 5, true, false);
         }
     }
@@ -2704,7 +3190,7 @@ void setSpeedLCD()
         if (isOverspeed)
         {
             // Show OVERSPEED on bottom line with proper units
-            float displaySpeed = surfaceSpeed;
+            float displaySpeed = velocityMsg.surface;
             String speedUnit = "m/s";
             if (useImperialUnits) {
                 displaySpeed *= 2.23693629; // m/s to mph
@@ -2715,7 +3201,7 @@ void setSpeedLCD()
         else if (isStall)
         {
             // Show STALL on bottom line with proper units
-            float displaySpeed = surfaceSpeed;
+            float displaySpeed = velocityMsg.surface;
             String speedUnit = "m/s";
             if (useImperialUnits) {
                 displaySpeed *= 2.23693629; // m/s to mph
@@ -2782,10 +3268,42 @@ void setAltitudeLCD()
 
     Output.setAltitudeLCD(topTxt, botTxt);
 }
+/// <summary>True if a cached page has to be rendered again: it never has been, one of its
+/// channels has had a frame since, or its key has changed. Marks it as rendered now.</summary>
+bool isPageStale(PageCache& page, uint64_t channels, uint32_t key)
+{
+    uint32_t stamp = Link.channelStamp(channels);
+    if (page.valid && page.stamp == stamp && page.key == key)
+        return false;
+    page.valid = true;
+    page.stamp = stamp;
+    page.key = key;
+    return true;
+}
+
+/// <summary>Local state an info page shows besides its channels.</summary>
+uint32_t infoPageKey(byte mode)
+{
+    uint32_t key = useImperialUnits;
+    if (mode == 9 && Input.getVirtualPin(VPIN_STAGE_VIEW_SWITCH, false) == ON)
+        key |= 2;
+    return key;
+}
+
+/// <summary>Show the info page, rendered again only if something on it has changed.</summary>
 void setInfoLCD()
 {
-    String topTxt = "";
-    String botTxt = "";
+    byte mode = infoMode <= LCD_PAGE_COUNT ? infoMode : 0;
+    PageCache& page = infoPages[mode];
+    if (isPageStale(page, INFO_PAGE_CHANNELS[mode], infoPageKey(mode)))
+        renderInfoPage(mode, page.top, page.bottom);
+    Output.setInfoLCD(page.top, page.bottom);
+}
+
+void renderInfoPage(byte mode, String& topTxt, String& botTxt)
+{
+    topTxt = "";
+    botTxt = "";
     // Helper: prefer fullLabel+value if it fits in 16 chars, otherwise use abbrev+value or value only
     auto composeLabelValue = [](const String &fullLabel, const String &abbrev, const String &value)->String {
         String cand = fullLabel;
@@ -2809,23 +3327,22 @@ void setInfoLCD()
 
     // Small helpers to format distances and speeds according to unit preference
     // Only convert units if the number won't fit in base units
+    // Integer math only, distances are too big for Q16.16 so they stay in whole meters
     auto formatDistance = [&](float meters)->String {
+        int32_t m = int_from_float_bits(meters);
         if (useImperialUnits) {
-            int feet = (int)(meters * 3.28084);
+            int32_t feet = fix16_scale_int(m, F16(3.28084));
             // Only use miles if feet won't fit (>99999 ft)
             if (feet > 99999) {
-                float miles = meters / 1609.34;
-                int whole = (int)miles;
-                int frac = (int)(miles * 10) % 10;
-                return String(whole) + "." + String(frac) + "mi";
+                int32_t tenthMiles = (int64_t)m * 1000 / 160934; // 1 mi = 1609.34 m
+                return String(tenthMiles / 10) + "." + String(tenthMiles % 10) + "mi";
             } else {
                 return String(feet) + "ft";
             }
         } else {
-            int m = (int)meters;
             // Only use km if meters won't fit (>99999 m)
             if (m > 99999) {
-                int km = getKilometers((int)meters);
+                int km = getKilometers(m);
                 return String(km) + "km";
             } else {
                 return String(m) + "m";
@@ -2834,29 +3351,27 @@ void setInfoLCD()
     };
 
     auto formatSpeed = [&](float mps)->String {
+        int32_t ms = int_from_float_bits(mps, true);
         if (useImperialUnits) {
-            int mph = (int)round(mps * 2.23693629);
+            int32_t mph = fix16_scale_int(ms, F16(2.23693629));
             // Only convert if mph won't fit (>99999)
             if (mph > 99999) {
-                float mps_imp = mph / 3600.0;
-                return String((int)mps_imp) + " mi/s";
+                return String(mph / 3600) + " mi/s";
             } else {
                 return String(mph) + " mph";
             }
         } else {
-            int ms = (int)round(mps);
             // Only convert if m/s won't fit (>9999)
             if (ms > 9999) {
-                float kms = mps / 1000.0;
-                return String((int)kms) + " km/s";
+                return String(ms / 1000) + " km/s";
             } else {
                 return String(ms) + " m/s";
             }
         }
     };
 
-    // Display data based on current info mode (1-12)
-    switch (infoMode)
+    // Display data based on the info mode (1-12)
+    switch (mode)
     {
         case 1:  // Apoapsis Time and Altitude
         {
@@ -3165,8 +3680,6 @@ void setInfoLCD()
             botTxt = "Select Mode";
             break;
     }
-
-    Output.setInfoLCD(topTxt, botTxt);
 }
 void setHeadingLCD()
 {
@@ -3203,109 +3716,147 @@ void setHeadingLCD()
 
     Output.setHeadingLCD(topTxt, botTxt);
 }
+/// <summary>Local state a direction page shows besides its channels.</summary>
+uint32_t directionPageKey(byte mode)
+{
+    switch (mode)
+    {
+    case 1:
+        return burnStartDeltaV;
+    case 10:
+        return currentSpeedMode;
+    case 11:
+    {
+        if (!autopilotEnabled)
+            return 0;
+        uint32_t key = fnv1a((const byte*)&autopilotHeading, sizeof(autopilotHeading), FNV_OFFSET_BASIS);
+        key = fnv1a((const byte*)&autopilotSpeed, sizeof(autopilotSpeed), key);
+        return fnv1a((const byte*)&autopilotAltitude, sizeof(autopilotAltitude), key);
+    }
+    case 12:
+        return (uint16_t)sentThrottle;
+    default:
+        return 0;
+    }
+}
+
+/// <summary>Show the direction page, rendered again only if something on it has changed.</summary>
 void setDirectionLCD()
 {
-    String topTxt = "";
-    String botTxt = "";
-    float heading = 0;
-    float pitch = 0;
+    byte mode = directionMode <= LCD_PAGE_COUNT ? directionMode : 0;
+    PageCache& page = directionPages[mode];
+    if (isPageStale(page, DIRECTION_PAGE_CHANNELS[mode], directionPageKey(mode)))
+        renderDirectionPage(mode, page.top, page.bottom);
+    Output.setDirectionLCD(page.top, page.bottom);
+}
+
+void renderDirectionPage(byte mode, String& topTxt, String& botTxt)
+{
+    topTxt = "";
+    botTxt = "";
+    // Directions Simpit sends as heading and pitch are shown as they are, the others are worked
+    // out from the prograde vector in the local east/north/up frame
+    fix16_t heading = fix16_from_float_bits(vesselPointingMsg.orbitalVelocityHeading);
+    fix16_t pitch = fix16_from_float_bits(vesselPointingMsg.orbitalVelocityPitch);
+    Vec3 prograde = vec3FromHeadingPitch(heading, pitch);
+    Vec3 direction = prograde;
+    bool fromVector = false;
     
-    // Get heading and pitch based on current direction mode (1-12)
-    switch (directionMode)
+    // Get heading and pitch based on the direction mode (1-12)
+    switch (mode)
     {
-        case 1:  // Maneuver Node
-            topTxt = "Maneuver Mode";
-            heading = maneuverMsg.headingNextManeuver;
-            pitch = maneuverMsg.pitchNextManeuver;
+        case 1:  // Maneuver Node, with burn progress once a node exists
+            if (burnStartDeltaV > 0)
+            {
+                int32_t remaining = int_from_float_bits(maneuverMsg.deltaVNextManeuver, true);
+                topTxt = "Burn " + Output.barGraph(11, burnStartDeltaV - remaining, burnStartDeltaV);
+            }
+            else
+            {
+                topTxt = "Maneuver Mode";
+            }
+            heading = fix16_from_float_bits(maneuverMsg.headingNextManeuver);
+            pitch = fix16_from_float_bits(maneuverMsg.pitchNextManeuver);
             break;
         case 2:  // Prograde (orbital velocity)
-            topTxt = "Prograde";
-            heading = vesselPointingMsg.orbitalVelocityHeading;
-            pitch = vesselPointingMsg.orbitalVelocityPitch;
+            topTxt = String(Output.glyphChar(GLYPH_PROGRADE)) + " Prograde";
             break;
         case 3:  // Retrograde (opposite of prograde)
             topTxt = "Retrograde";
-            heading = vesselPointingMsg.orbitalVelocityHeading + 180.0;
-            if (heading >= 360.0) heading -= 360.0;
-            pitch = -vesselPointingMsg.orbitalVelocityPitch;
+            direction = vec3Negate(prograde);
+            fromVector = true;
             break;
-        case 4:  // Normal (perpendicular to orbital plane, +90 pitch from prograde)
+        case 4:  // Normal (perpendicular to the orbital plane, along the angular momentum)
             topTxt = "Normal";
-            heading = vesselPointingMsg.orbitalVelocityHeading + 90.0;
-            if (heading >= 360.0) heading -= 360.0;
-            pitch = 0;  // Normal is perpendicular to orbital plane
+            direction = navNormal(prograde);
+            fromVector = true;
             break;
         case 5:  // Anti-Normal (opposite of normal)
             topTxt = "Anti-Normal";
-            heading = vesselPointingMsg.orbitalVelocityHeading - 90.0;
-            if (heading < 0.0) heading += 360.0;
-            pitch = 0;
+            direction = vec3Negate(navNormal(prograde));
+            fromVector = true;
             break;
-        case 6:  // Radial In (toward planet center)
+        case 6:  // Radial In (toward planet center, perpendicular to prograde)
             topTxt = "Radial In";
-            heading = vesselPointingMsg.orbitalVelocityHeading;
-            pitch = -90;  // Radial in points down
+            direction = vec3Negate(navRadialOut(prograde));
+            fromVector = true;
             break;
-        case 7:  // Radial Out (away from planet center)
+        case 7:  // Radial Out (away from planet center, perpendicular to prograde)
             topTxt = "Radial Out";
-            heading = vesselPointingMsg.orbitalVelocityHeading;
-            pitch = 90;  // Radial out points up
+            direction = navRadialOut(prograde);
+            fromVector = true;
             break;
         case 8:  // Target
             topTxt = "Target";
-            heading = targetMsg.heading;
-            pitch = targetMsg.pitch;
+            heading = fix16_from_float_bits(targetMsg.heading);
+            pitch = fix16_from_float_bits(targetMsg.pitch);
             break;
-        case 9:  // Combined: Anti-Target and Velocity (based on reference mode)
+        case 9:  // Anti-Target (opposite of target)
             topTxt = "Anti-Target";
-            heading = targetMsg.heading + 180.0;
-            if (heading >= 360.0) heading -= 360.0;
-            pitch = -targetMsg.pitch;
+            direction = vec3Negate(vec3FromHeadingPitch(fix16_from_float_bits(targetMsg.heading), fix16_from_float_bits(targetMsg.pitch)));
+            fromVector = true;
             break;
         case 10:  // Velocity direction based on current reference mode
             // Show surface or orbital velocity based on speed mode
             if (currentSpeedMode == SPEED_SURFACE_MODE)
             {
                 topTxt = "Surface Velocity";
-                heading = vesselPointingMsg.surfaceVelocityHeading;
-                pitch = vesselPointingMsg.surfaceVelocityPitch;
+                heading = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityHeading);
+                pitch = fix16_from_float_bits(vesselPointingMsg.surfaceVelocityPitch);
             }
             else  // SPEED_ORBIT_MODE or SPEED_TARGET_MODE - use orbital
             {
                 topTxt = "Orbital Velocity";
-                heading = vesselPointingMsg.orbitalVelocityHeading;
-                pitch = vesselPointingMsg.orbitalVelocityPitch;
             }
             break;
         case 11:  // Autopilot Status
             if (autopilotEnabled)
             {
                 // Show autopilot target values with prograde indicator
-                topTxt = "AP PG:" + String((int)autopilotHeading);
-                topTxt += " " + String((int)autopilotSpeed) + "m/s";
+                topTxt = "AP PG:" + String(fix16_to_int(autopilotHeading));
+                topTxt += " " + String(fix16_to_int(autopilotSpeed)) + "m/s";
                 
                 // Show altitude target and current error
-                float currentAlt = altitudeMsg.sealevel;
-                float altErr = autopilotAltitude - currentAlt;
-                botTxt = "ALT:" + String((int)autopilotAltitude);
-                botTxt += " E:" + String((int)altErr) + "m";
+                fix16_t currentAlt = fix16_from_float_bits(altitudeMsg.sealevel);
+                fix16_t altErr = fix16_sub(autopilotAltitude, currentAlt);
+                botTxt = "ALT:" + String(fix16_to_int(autopilotAltitude));
+                botTxt += " E:" + String(fix16_to_int(altErr)) + "m";
             }
             else
             {
                 topTxt = "Autopilot";
                 botTxt = "Disabled";
             }
-            Output.setDirectionLCD(topTxt, botTxt);
             return;
-        case 12:  // Unused
-            topTxt = "Direction 12";
-            botTxt = "Unused";
-            Output.setDirectionLCD(topTxt, botTxt);
+        case 12:  // Throttle bar
+            topTxt = "Throttle    ";
+            topTxt += formatNumber((int)((int32_t)sentThrottle * 100 / INT16_MAX), 3, false, false);
+            topTxt += "%";
+            botTxt = Output.barGraph(16, sentThrottle, INT16_MAX);
             return;
         default:
             topTxt = "Direction";
             botTxt = "Select Mode";
-            Output.setDirectionLCD(topTxt, botTxt);
             return;
     }
     
@@ -3315,14 +3866,15 @@ void setDirectionLCD()
     topTxt = modeName;  // Keep mode name simple on top line
     
     // Format bottom line: "HDG" + heading + "PTH" + pitch (all on one line)
+    if (fromVector)
+        vec3ToHeadingPitch(direction, heading, pitch);
+    // Rounded, the vector path lands a hair either side of a whole degree
     botTxt = "HDG ";
-    botTxt += formatNumber((int)heading, 3, false, false);
+    botTxt += formatNumber(fix16_round(fix16_wrap360(heading)) % 360, 3, false, false);
     botTxt += DEGREE_CHAR_LCD;
     botTxt += " PTH";
-    botTxt += formatNumber((int)pitch, 3, true, false);
+    botTxt += formatNumber(fix16_round(pitch), 3, true, false);
     botTxt += DEGREE_CHAR_LCD;
-    
-    Output.setDirectionLCD(topTxt, botTxt);
 }
 
 
@@ -3333,7 +3885,7 @@ void setDirectionLCD()
 int16_t smoothAndMapAxis(int raw, bool flip)//, bool isSmooth = true)
 {
     // Check center deadzone first
-    if (raw > 512 - JOYSTICK_DEADZONE_CENTER && raw < 512 + JOYSTICK_DEADZONE_CENTER)
+    if (raw > 512 - joystickDeadzoneCenter && raw < 512 + joystickDeadzoneCenter)
     {
         // Within center deadzone - return zero
         return 0;
@@ -3341,10 +3893,10 @@ int16_t smoothAndMapAxis(int raw, bool flip)//, bool isSmooth = true)
 
     // Apply edge deadzone and map the value
     // For values outside center deadzone, map from edge of center deadzone to edges
-    int min = JOYSTICK_DEADZONE;
-    int max = 1023 - JOYSTICK_DEADZONE;
-    int centerMin = 512 - JOYSTICK_DEADZONE_CENTER;
-    int centerMax = 512 + JOYSTICK_DEADZONE_CENTER;
+    int min = joystickDeadzone;
+    int max = 1023 - joystickDeadzone;
+    int centerMin = 512 - joystickDeadzoneCenter;
+    int centerMax = 512 + joystickDeadzoneCenter;
     
     // Map lower range (min to centerMin) to (INT16_MIN to 0)
     // When pulling back (raw decreasing from 512), output should go negative
@@ -3369,12 +3921,9 @@ int16_t smoothAndMapAxis(int raw, bool flip)//, bool isSmooth = true)
 }
 
 // Helper: shortest signed angle difference (target - current) in degrees (-180..180]
-float shortestAngleDiff(float target, float current)
+fix16_t shortestAngleDiff(fix16_t target, fix16_t current)
 {
-    float d = target - current;
-    while (d > 180.0f) d -= 360.0f;
-    while (d <= -180.0f) d += 360.0f;
-    return d;
+    return fix16_wrap180(fix16_sub(target, current));
 }
 
 void calcResource(float total, float avail, bool* newLEDs)
@@ -3529,16 +4078,204 @@ int16_t dualPlayerHelper(int16_t x1, int16_t x2)
     return x;
 }
 
-void printDebug(String msg) 
+/// <summary>Print waiting trace records while the debug switch is on. Formatting only happens here.</summary>
+void drainTrace()
 {
-    if (isConnectedToKSP && Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) == ON)
+    if (Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) != ON)
+        return;
+    if (!isConnectedToKSP)
     {
-        mySimpit.printToKSP(msg, PRINT_TO_SCREEN);
+        Trace.dump(Serial);
+        return;
     }
-    else if (Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) == ON)
+    // To the KSP screen, a few lines per loop so the diagnostics queue keeps up
+    TraceRecord record;
+    char line[TRACE_LINE_LENGTH];
+    for (byte i = 0; i < TRACE_LINES_PER_LOOP && Trace.pop(record); i++)
     {
-        Serial.println(msg);
+        Trace.format(record, line, sizeof(line));
+        Outbound.printToKSP(line, PRINT_TO_SCREEN);
     }
 }
 
+/// <summary>Service the diagnostics console on whichever port it can use right now.</summary>
+void updateConsole()
+{
+    if (CONSOLE_ON_NATIVE_USB)
+        Console.update(SerialUSB);
+    else if (!isConnectedToKSP && Input.getVirtualPin(VPIN_DEBUG_SWITCH, false) == ON)
+        Console.update(Serial);
+}
 
+/// <summary>led &lt;first&gt; [last]: light one LED or a range with all others off. led off ends the test.</summary>
+void consoleLed(Print& out, byte argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        out.println("Usage: led <first> [last] | led off");
+        return;
+    }
+    if (strcmp(argv[1], "off") == 0)
+    {
+        setAllOutputs(false);
+        ledTestActive = false;
+        out.println("LED test off");
+        return;
+    }
+    int first = atoi(argv[1]);
+    int last = argc > 2 ? atoi(argv[2]) : first;
+    if (first < 0 || last > TOTAL_LEDS || first > last)
+    {
+        out.print("Invalid LED, use 0-");
+        out.println(TOTAL_LEDS);
+        return;
+    }
+    ledTestActive = true;
+    setAllOutputs(false);
+    for (int i = first; i <= last; i++)
+    {
+        Output.setLED(i, true);
+    }
+    char line[40];
+    snprintf(line, sizeof(line), "LED %d-%d on", first, last);
+    out.println(line);
+}
+
+/// <summary>inputs: raw and debounced input words.</summary>
+void consoleInputs(Print& out, byte argc, char* argv[])
+{
+    Input.printState(out);
+}
+
+/// <summary>prof: refresh, capture, idle, queue and boot figures.</summary>
+void consoleProf(Print& out, byte argc, char* argv[])
+{
+    char line[72];
+    OutputRefreshStats refreshStats;
+    Output.getRefreshStats(refreshStats);
+    snprintf(line, sizeof(line), "LED refresh: %lu Hz, ISR load %lu/1000, max ISR %lu us",
+        (unsigned long)refreshStats.frameRateHz, (unsigned long)refreshStats.cpuLoadPermille, (unsigned long)refreshStats.maxIsrMicros);
+    out.println(line);
+
+    if (Input.isCapturing())
+    {
+        InputCaptureStats captureStats;
+        Input.getCaptureStats(captureStats);
+        snprintf(line, sizeof(line), "Input capture: %lu edges, %lu dropped, max queue %lu",
+            (unsigned long)captureStats.edges, (unsigned long)captureStats.overflows, (unsigned long)captureStats.maxDepth);
+        out.println(line);
+    }
+
+    // Idle share of the current report window, reportIdle() starts a new one every two seconds
+    uint32_t window = micros() - idleReportStart;
+    int idlePercent = window > 0 ? (int)((uint64_t)idleMicros * 100 / window) : 0;
+    snprintf(line, sizeof(line), "Idle: %d%% asleep, entered %lu times, %s", idlePercent, (unsigned long)idleEntries, isIdle ? "idle" : "awake");
+    out.println(line);
+
+    if (isConnectedToKSP)
+    {
+        OutboundStats outboundStats;
+        Outbound.getStats(outboundStats);
+        snprintf(line, sizeof(line), "Outbound: %lu sent, %lu dropped, %lu coalesced, %lu stalls",
+            (unsigned long)outboundStats.sent, (unsigned long)outboundStats.dropped,
+            (unsigned long)outboundStats.coalesced, (unsigned long)outboundStats.stalls);
+        out.println(line);
+    }
+
+    snprintf(line, sizeof(line), "Trace: %d waiting, %lu lost", Trace.pending(), (unsigned long)Trace.lost());
+    out.println(line);
+    snprintf(line, sizeof(line), "Boot ms: setup %ld, IO %ld, self-test %ld, Simpit %ld, first frame %ld",
+        bootPhaseMillis(BOOT_SETUP_START), bootPhaseMillis(BOOT_IO_READY), bootPhaseMillis(BOOT_SELF_TEST_DONE),
+        bootPhaseMillis(BOOT_SIMPIT_CONNECTED), bootPhaseMillis(BOOT_FIRST_FRAME));
+    out.println(line);
+}
+
+/// <summary>trace: print and drain the waiting trace records.</summary>
+void consoleTrace(Print& out, byte argc, char* argv[])
+{
+    if (Trace.pending() == 0)
+        out.println("Trace empty");
+    Trace.dump(out);
+}
+
+/// <summary>link: Simpit link state and counters.</summary>
+void consoleLink(Print& out, byte argc, char* argv[])
+{
+    LinkStats stats;
+    Link.getStats(stats);
+    const char* stateName = stats.state == LINK_UP ? "up" : stats.state == LINK_DEGRADED ? "degraded" : "down";
+    char line[72];
+    snprintf(line, sizeof(line), "Link %s, %lu frames, %lu ms silent", stateName,
+        (unsigned long)stats.frames, (unsigned long)stats.millisSinceFrame);
+    out.println(line);
+    snprintf(line, sizeof(line), "%lu drops, %lu reconnects, last took %lu ms",
+        (unsigned long)stats.drops, (unsigned long)stats.reconnects, (unsigned long)stats.lastReconnectMillis);
+    out.println(line);
+}
+
+/// <summary>set [deadzone|center|filter|brightness value]: change the joystick deadzones, the throttle filter or the LED brightness, then list them.</summary>
+void consoleSet(Print& out, byte argc, char* argv[])
+{
+    if (argc == 3)
+    {
+        if (strcmp(argv[1], "deadzone") == 0 || strcmp(argv[1], "center") == 0)
+        {
+            bool isEdge = argv[1][0] == 'd';
+            int value = atoi(argv[2]);
+            int other = isEdge ? joystickDeadzoneCenter : joystickDeadzone;
+            // The edge and center deadzones have to leave some travel between them
+            if (value < 0 || value + other >= 512)
+                out.println("Deadzones must add up to less than 512");
+            else if (isEdge)
+                joystickDeadzone = value;
+            else
+                joystickDeadzoneCenter = value;
+        }
+        else if (strcmp(argv[1], "filter") == 0)
+        {
+            float value = atof(argv[2]);
+            if (value < 0 || value > 1)
+                out.println("Filter must be 0-1");
+            else
+                throttleSmoothAlpha = F16(value);
+        }
+        else if (strcmp(argv[1], "brightness") == 0)
+        {
+            int value = atoi(argv[2]);
+            if (value < 0 || value > LED_MAX_BRIGHTNESS)
+            {
+                out.print("Brightness must be 0-");
+                out.println(LED_MAX_BRIGHTNESS);
+            }
+            else
+                Output.setGlobalBrightness(value);
+        }
+        else
+        {
+            out.print("Unknown setting: ");
+            out.println(argv[1]);
+        }
+    }
+    else if (argc != 1)
+    {
+        out.println("Usage: set [deadzone|center|filter|brightness value]");
+    }
+
+    out.print("deadzone ");
+    out.print(joystickDeadzone);
+    out.print(", center ");
+    out.print(joystickDeadzoneCenter);
+    out.print(", filter ");
+    out.print(fix16_to_float(throttleSmoothAlpha), 2);
+    out.print(", brightness ");
+    out.println(Output.getGlobalBrightness());
+}
+
+const ConsoleCommand CONSOLE_COMMANDS[CONSOLE_COMMAND_COUNT] = {
+    { "led", "led <first> [last] | led off", consoleLed },
+    { "inputs", "inputs", consoleInputs },
+    { "prof", "prof", consoleProf },
+    { "trace", "trace", consoleTrace },
+    { "link", "link", consoleLink },
+    { "set", "set [deadzone|center|filter|brightness value]", consoleSet }
+};
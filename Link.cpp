@@ -0,0 +1,133 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "Link.h"
+
+#pragma region Private
+
+LinkState _state = LINK_DOWN;
+bool _everUp = false;
+unsigned long _lastFrame = 0;                       // millis() of the last inbound frame
+unsigned long _channelLast[LINK_CHANNEL_COUNT];     // millis() per message type
+uint32_t _channelSeq[LINK_CHANNEL_COUNT];           // Frames per message type
+unsigned long _lastProbe = 0;
+unsigned long _downSince = 0;
+
+uint32_t _frames = 0;
+uint32_t _drops = 0;
+uint32_t _reconnects = 0;
+uint32_t _lastReconnectMillis = 0;
+
+#pragma endregion
+
+
+#pragma region Public
+
+void LinkClass::begin()
+{
+    unsigned long now = millis();
+    if (_everUp && _state == LINK_DOWN)
+    {
+        _reconnects++;
+        _lastReconnectMillis = now - _downSince;
+    }
+    _everUp = true;
+    _state = LINK_UP;
+    // The handshake counts as a frame
+    _lastFrame = now;
+}
+
+void LinkClass::onMessage(byte messageType)
+{
+    unsigned long now = millis();
+    _lastFrame = now;
+    _frames++;
+    if (messageType < LINK_CHANNEL_COUNT)
+    {
+        _channelLast[messageType] = now;
+        _channelSeq[messageType]++;
+    }
+}
+
+LinkState LinkClass::update()
+{
+    if (_state == LINK_DOWN)
+        return _state;
+
+    unsigned long silence = millis() - _lastFrame;
+    if (silence >= LINK_DOWN_TIMEOUT)
+    {
+        _state = LINK_DOWN;
+        _drops++;
+        _downSince = millis();
+    }
+    else if (silence >= LINK_DEGRADED_TIMEOUT)
+    {
+        _state = LINK_DEGRADED;
+    }
+    else
+    {
+        _state = LINK_UP;
+    }
+    return _state;
+}
+
+bool LinkClass::probeDue()
+{
+    if (_state != LINK_DEGRADED || millis() - _lastProbe < LINK_PROBE_INTERVAL)
+        return false;
+    _lastProbe = millis();
+    return true;
+}
+
+LinkState LinkClass::getState()
+{
+    return _state;
+}
+
+unsigned long LinkClass::millisSinceFrame()
+{
+    return millis() - _lastFrame;
+}
+
+unsigned long LinkClass::millisSinceChannel(byte messageType)
+{
+    if (messageType >= LINK_CHANNEL_COUNT || _channelSeq[messageType] == 0)
+        return ULONG_MAX;
+    return millis() - _channelLast[messageType];
+}
+
+uint32_t LinkClass::channelSeq(byte messageType)
+{
+    return messageType < LINK_CHANNEL_COUNT ? _channelSeq[messageType] : 0;
+}
+
+uint32_t LinkClass::channelStamp(uint64_t channels)
+{
+    uint32_t stamp = 0;
+    for (byte type = 0; type < LINK_CHANNEL_COUNT && channels != 0; type++, channels >>= 1)
+    {
+        if (channels & 1)
+            stamp += _channelSeq[type];
+    }
+    return stamp;
+}
+
+void LinkClass::getStats(LinkStats& stats)
+{
+    stats.state = _state;
+    stats.frames = _frames;
+    stats.drops = _drops;
+    stats.reconnects = _reconnects;
+    stats.lastReconnectMillis = _lastReconnectMillis;
+    stats.millisSinceFrame = millisSinceFrame();
+}
+
+#pragma endregion
+
+
+LinkClass Link;
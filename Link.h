@@ -0,0 +1,75 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Link.h
+// Health of the Simpit serial link, judged by the time since the last inbound frame.
+
+#ifndef _LINK_h
+#define _LINK_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+#include <limits.h>
+
+// Silence before the link counts as degraded or down (milliseconds)
+#define LINK_DEGRADED_TIMEOUT 1500
+#define LINK_DOWN_TIMEOUT     4000
+// Time between echo probes while degraded (milliseconds)
+#define LINK_PROBE_INTERVAL   500
+// Message types tracked per channel
+#define LINK_CHANNEL_COUNT    64
+// Bit for a message type in a set of channels, see LinkClass::channelStamp()
+#define LINK_CHANNEL(messageType) ((uint64_t)1 << (messageType))
+
+enum LinkState
+{
+    LINK_DOWN,          // No handshake yet, or silent for LINK_DOWN_TIMEOUT
+    LINK_DEGRADED,      // Silent for LINK_DEGRADED_TIMEOUT, being probed
+    LINK_UP
+};
+
+// Link figures, see LinkClass::getStats()
+struct LinkStats
+{
+    LinkState state;
+    uint32_t frames;                // Inbound frames since boot
+    uint32_t drops;                 // Times the link went down after being up
+    uint32_t reconnects;            // Handshakes after a drop
+    uint32_t lastReconnectMillis;   // Time from the last drop to its handshake
+    uint32_t millisSinceFrame;      // Silence so far
+};
+
+class LinkClass
+{
+public:
+
+	// Handshake done, the link is up
+	void begin();
+	// Any valid inbound frame, called from the Simpit inbound handler
+	void onMessage(byte messageType);
+	// Re-evaluate the state from the time since the last frame
+	LinkState update();
+	// True once per LINK_PROBE_INTERVAL while degraded, time to send an echo request
+	bool probeDue();
+
+	LinkState getState();
+	unsigned long millisSinceFrame();
+	// Time since a message type last arrived, ULONG_MAX if it never has
+	unsigned long millisSinceChannel(byte messageType);
+	// Goes up by one per frame of a message type. Compare with an older value to see if it has updated.
+	uint32_t channelSeq(byte messageType);
+	// Changes whenever any of a set of channels gets a frame (sum of their channelSeq)
+	uint32_t channelStamp(uint64_t channels);
+	void getStats(LinkStats& stats);
+};
+
+extern LinkClass Link;
+
+#endif
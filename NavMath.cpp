@@ -0,0 +1,182 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "NavMath.h"
+
+#pragma region Private
+
+// sin(0..90 degrees) in whole degree steps
+const fix16_t _SIN_TABLE[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987,
+    9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+    18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+    26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+    34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+    48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+    54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+    58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+    62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+    65496, 65526, 65536
+};
+
+// atan(0..1) in degrees, in steps of 1/64
+const int _ATAN_STEPS = 64;
+const fix16_t _ATAN_TABLE[_ATAN_STEPS + 1] = {
+    0, 58666, 117304, 175884, 234379, 292760, 350999, 409070,
+    466945, 524598, 582003, 639135, 695970, 752484, 808654, 864460,
+    919879, 974893, 1029481, 1083627, 1137313, 1190524, 1243245, 1295461,
+    1347161, 1398332, 1448965, 1499049, 1548575, 1597536, 1645926, 1693738,
+    1740967, 1787610, 1833663, 1879123, 1923990, 1968261, 2011937, 2055018,
+    2097505, 2139399, 2180703, 2221419, 2261551, 2301101, 2340074, 2378474,
+    2416306, 2453574, 2490285, 2526443, 2562055, 2597126, 2631664, 2665673,
+    2699161, 2732134, 2764600, 2796564, 2828035, 2859019, 2889523, 2919554,
+    2949120
+};
+
+/// <summary>Linear interpolation into a table. index is Q16.16, its whole part must be below the last entry.</summary>
+fix16_t _lookup(const fix16_t* table, fix16_t index)
+{
+    int i = index >> 16;
+    fix16_t frac = index & 0xFFFF;
+    return table[i] + (fix16_t)(((int64_t)(table[i + 1] - table[i]) * frac) >> 16);
+}
+
+/// <summary>sin of 0..90 degrees.</summary>
+fix16_t _sinQuarter(fix16_t degrees)
+{
+    if (degrees >= F16(90)) return FIX16_ONE;
+    return _lookup(_SIN_TABLE, degrees);
+}
+
+/// <summary>atan of a ratio in 0..1, in degrees.</summary>
+fix16_t _atanUnit(fix16_t ratio)
+{
+    if (ratio >= FIX16_ONE) return F16(45);
+    return _lookup(_ATAN_TABLE, ratio * _ATAN_STEPS);
+}
+
+#pragma endregion
+
+
+#pragma region Public
+
+fix16_t navSin(fix16_t degrees)
+{
+    degrees = fix16_wrap360(degrees);
+    // Fold into the first quarter using the symmetry of the wave
+    bool negative = degrees >= F16(180);
+    if (negative) degrees -= F16(180);
+    if (degrees > F16(90)) degrees = F16(180) - degrees;
+    fix16_t s = _sinQuarter(degrees);
+    return negative ? -s : s;
+}
+
+fix16_t navCos(fix16_t degrees)
+{
+    return navSin(fix16_wrap360(degrees) + F16(90));
+}
+
+fix16_t navAtan2(fix16_t y, fix16_t x)
+{
+    if (x == 0 && y == 0) return 0;
+
+    // Angle in the first octant, then unfold by the signs and which side is bigger
+    int64_t ax = x < 0 ? -(int64_t)x : x;
+    int64_t ay = y < 0 ? -(int64_t)y : y;
+    fix16_t angle;
+    if (ay <= ax) angle = _atanUnit((fix16_t)((ay << 16) / ax));
+    else angle = F16(90) - _atanUnit((fix16_t)((ax << 16) / ay));
+
+    if (x < 0) angle = F16(180) - angle;
+    return y < 0 ? -angle : angle;
+}
+
+Vec3 vec3(fix16_t x, fix16_t y, fix16_t z)
+{
+    Vec3 v = { x, y, z };
+    return v;
+}
+
+Vec3 vec3Negate(const Vec3& v)
+{
+    return vec3(-v.x, -v.y, -v.z);
+}
+
+Vec3 vec3Sub(const Vec3& a, const Vec3& b)
+{
+    return vec3(fix16_sub(a.x, b.x), fix16_sub(a.y, b.y), fix16_sub(a.z, b.z));
+}
+
+Vec3 vec3Scale(const Vec3& v, fix16_t s)
+{
+    return vec3(fix16_mul(v.x, s), fix16_mul(v.y, s), fix16_mul(v.z, s));
+}
+
+fix16_t vec3Dot(const Vec3& a, const Vec3& b)
+{
+    // Sum in 64 bits and round once
+    int64_t sum = (int64_t)a.x * b.x + (int64_t)a.y * b.y + (int64_t)a.z * b.z;
+    sum += sum >= 0 ? FIX16_HALF : -FIX16_HALF;
+    return fix16_saturate(sum / FIX16_ONE);
+}
+
+Vec3 vec3Cross(const Vec3& a, const Vec3& b)
+{
+    return vec3(
+        fix16_sub(fix16_mul(a.y, b.z), fix16_mul(a.z, b.y)),
+        fix16_sub(fix16_mul(a.z, b.x), fix16_mul(a.x, b.z)),
+        fix16_sub(fix16_mul(a.x, b.y), fix16_mul(a.y, b.x)));
+}
+
+fix16_t vec3Length(const Vec3& v)
+{
+    // The squares are Q32.32, so their root is already Q16.16
+    uint64_t sum = (uint64_t)((int64_t)v.x * v.x) + (uint64_t)((int64_t)v.y * v.y) + (uint64_t)((int64_t)v.z * v.z);
+    return fix16_saturate(isqrt64(sum));
+}
+
+Vec3 vec3Normalize(const Vec3& v)
+{
+    fix16_t length = vec3Length(v);
+    if (length == 0) return vec3(0, 0, 0);
+    return vec3(fix16_div(v.x, length), fix16_div(v.y, length), fix16_div(v.z, length));
+}
+
+Vec3 vec3FromHeadingPitch(fix16_t heading, fix16_t pitch)
+{
+    fix16_t horizontal = navCos(pitch);
+    return vec3(fix16_mul(horizontal, navSin(heading)),
+        fix16_mul(horizontal, navCos(heading)),
+        navSin(pitch));
+}
+
+void vec3ToHeadingPitch(const Vec3& v, fix16_t& heading, fix16_t& pitch)
+{
+    Vec3 flat = vec3(v.x, v.y, 0);
+    fix16_t horizontal = vec3Length(flat);
+    // Straight up or down has no heading, keep north
+    heading = horizontal == 0 ? 0 : fix16_wrap360(navAtan2(v.x, v.y));
+    pitch = navAtan2(v.z, horizontal);
+}
+
+Vec3 navNormal(const Vec3& prograde)
+{
+    // Position points up from the body, so the angular momentum r x v lies along Up x prograde.
+    // For an eastward equatorial orbit this points north, like the navball's normal marker.
+    const Vec3 up = { 0, 0, FIX16_ONE };
+    return vec3Normalize(vec3Cross(up, prograde));
+}
+
+Vec3 navRadialOut(const Vec3& prograde)
+{
+    const Vec3 up = { 0, 0, FIX16_ONE };
+    return vec3Normalize(vec3Sub(up, vec3Scale(prograde, vec3Dot(up, prograde))));
+}
+
+#pragma endregion
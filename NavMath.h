@@ -0,0 +1,55 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// NavMath.h
+// Table driven trig and 3D vectors in Q16.16, for navball directions.
+// Angles are degrees. Vectors are in the vessel's local frame: x = east, y = north, z = up.
+
+#ifndef _NAVMATH_h
+#define _NAVMATH_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+#include "FixedPoint.h"
+
+struct Vec3
+{
+    fix16_t x;  // East
+    fix16_t y;  // North
+    fix16_t z;  // Up
+};
+
+// Trig, about 0.0001 error from linear interpolation between table entries
+fix16_t navSin(fix16_t degrees);
+fix16_t navCos(fix16_t degrees);
+// Angle of (x, y) in degrees, (-180, 180]
+fix16_t navAtan2(fix16_t y, fix16_t x);
+
+// Vectors
+Vec3 vec3(fix16_t x, fix16_t y, fix16_t z);
+Vec3 vec3Negate(const Vec3& v);
+Vec3 vec3Sub(const Vec3& a, const Vec3& b);
+Vec3 vec3Scale(const Vec3& v, fix16_t s);
+fix16_t vec3Dot(const Vec3& a, const Vec3& b);
+Vec3 vec3Cross(const Vec3& a, const Vec3& b);
+fix16_t vec3Length(const Vec3& v);
+// Unit vector, zero stays zero
+Vec3 vec3Normalize(const Vec3& v);
+
+// Navball heading (0-360) and pitch (-90..90) to a unit vector, and back
+Vec3 vec3FromHeadingPitch(fix16_t heading, fix16_t pitch);
+void vec3ToHeadingPitch(const Vec3& v, fix16_t& heading, fix16_t& pitch);
+
+// Orbital directions from the prograde vector (unit, local frame)
+Vec3 navNormal(const Vec3& prograde);       // Along the orbit's angular momentum (Up x prograde)
+Vec3 navRadialOut(const Vec3& prograde);    // Up with the prograde component removed
+
+#endif
@@ -0,0 +1,370 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "Outbound.h"
+
+#pragma region Private
+
+// What a queued message does when it is sent
+enum _OutboundOp
+{
+    _OP_SEND,           // Raw payload on a channel
+    _OP_ACTIVATE,       // Action group on
+    _OP_DEACTIVATE,     // Action group off
+    _OP_TOGGLE_CAG,     // Custom action group toggle
+    _OP_SAS_MODE,
+    _OP_NAVBALL,
+    _OP_REQUEST,        // Ask KSP to resend a channel
+    _OP_PRINT           // Text to KSP
+};
+
+struct _OutboundMessage
+{
+    byte op;
+    byte arg;           // Channel, action, mode or print options
+    byte size;
+    union
+    {
+        byte payload[OUTBOUND_MAX_PAYLOAD];
+        char text[OUTBOUND_MAX_TEXT + 1];
+    };
+};
+
+// Fixed size FIFO of messages
+struct _OutboundQueue
+{
+    _OutboundMessage* items;
+    byte capacity;
+    byte head;
+    byte count;
+    byte maxCount;
+};
+
+// Pending value per axis channel
+struct _AxisSlot
+{
+    byte messageType;
+    byte size;
+    bool pending;
+    byte payload[OUTBOUND_MAX_PAYLOAD];
+};
+
+KerbalSimpit* _simpit = nullptr;
+UARTClass* _port = nullptr;
+
+_OutboundMessage _safetyItems[OUTBOUND_SAFETY_SIZE];
+_OutboundMessage _commandItems[OUTBOUND_COMMAND_SIZE];
+_OutboundMessage _diagItems[OUTBOUND_DIAG_SIZE];
+_OutboundQueue _queues[OUTBOUND_PRIORITY_COUNT] = {
+    { _safetyItems, OUTBOUND_SAFETY_SIZE, 0, 0, 0 },
+    { _commandItems, OUTBOUND_COMMAND_SIZE, 0, 0, 0 },
+    { nullptr, 0, 0, 0, 0 },   // Axes use _axisSlots
+    { _diagItems, OUTBOUND_DIAG_SIZE, 0, 0, 0 }
+};
+_AxisSlot _axisSlots[OUTBOUND_AXIS_SLOTS];
+byte _axisSlotCount = 0;
+byte _axisMaxPending = 0;
+byte _nextAxisSlot = 0;     // Round robin so one busy axis can not starve the others
+
+uint32_t _sentCount = 0;
+uint32_t _droppedCount = 0;
+uint32_t _coalescedCount = 0;
+uint32_t _stallCount = 0;
+
+/// <summary>Reserve the next message at the back of a queue, nullptr if it is full.</summary>
+_OutboundMessage* _push(OutboundPriority priority)
+{
+    _OutboundQueue& q = _queues[priority];
+    if (q.count >= q.capacity)
+    {
+        _droppedCount++;
+        return nullptr;
+    }
+    _OutboundMessage* msg = &q.items[(q.head + q.count) % q.capacity];
+    q.count++;
+    if (q.count > q.maxCount) q.maxCount = q.count;
+    return msg;
+}
+
+/// <summary>Queue a message that has no payload.</summary>
+bool _pushOp(OutboundPriority priority, byte op, byte arg)
+{
+    _OutboundMessage* msg = _push(priority);
+    if (msg == nullptr) return false;
+    msg->op = op;
+    msg->arg = arg;
+    msg->size = 1;
+    return true;
+}
+
+/// <summary>Length of the next print frame of a text, broken at a space in its second half if it
+/// has one. A space at the break is dropped.</summary>
+byte _textPieceLength(const char* text)
+{
+    if (memchr(text, '\0', OUTBOUND_MAX_TEXT + 1) != nullptr)
+        return strlen(text);
+    for (byte cut = OUTBOUND_MAX_TEXT; cut > OUTBOUND_MAX_TEXT / 2; cut--)
+    {
+        if (text[cut] == ' ') return cut;
+    }
+    return OUTBOUND_MAX_TEXT;
+}
+
+/// <summary>Serial bytes a message will take once framed.</summary>
+int _frameSize(byte size)
+{
+    return size + OUTBOUND_FRAME_OVERHEAD;
+}
+
+/// <summary>True if the serial TX buffer can take a frame without blocking.</summary>
+bool _hasRoom(byte size)
+{
+    return _port->availableForWrite() >= _frameSize(size);
+}
+
+/// <summary>Hand a queued message to the Simpit library.</summary>
+void _dispatch(_OutboundMessage& msg)
+{
+    switch (msg.op)
+    {
+    case _OP_SEND:       _simpit->send(msg.arg, msg.payload, msg.size); break;
+    case _OP_ACTIVATE:   _simpit->activateAction(msg.arg); break;
+    case _OP_DEACTIVATE: _simpit->deactivateAction(msg.arg); break;
+    case _OP_TOGGLE_CAG: _simpit->toggleCAG(msg.arg); break;
+    case _OP_SAS_MODE:   _simpit->setSASMode(msg.arg); break;
+    case _OP_NAVBALL:    _simpit->cycleNavBallMode(); break;
+    case _OP_REQUEST:    _simpit->requestMessageOnChannel(msg.arg); break;
+    case _OP_PRINT:      _simpit->printToKSP(msg.text, msg.arg); break;
+    }
+    _sentCount++;
+}
+
+/// <summary>Send from the front of a queue until it is empty or the TX buffer is full.</summary>
+bool _flushQueue(_OutboundQueue& q)
+{
+    while (q.count > 0)
+    {
+        _OutboundMessage& msg = q.items[q.head];
+        if (!_hasRoom(msg.size)) return false;
+        _dispatch(msg);
+        q.head = (q.head + 1) % q.capacity;
+        q.count--;
+    }
+    return true;
+}
+
+/// <summary>Send every pending axis value, starting after the last one sent.</summary>
+bool _flushAxes()
+{
+    for (byte n = 0; n < _axisSlotCount; n++)
+    {
+        _AxisSlot& slot = _axisSlots[_nextAxisSlot];
+        if (slot.pending)
+        {
+            if (!_hasRoom(slot.size)) return false;
+            _simpit->send(slot.messageType, slot.payload, slot.size);
+            slot.pending = false;
+            _sentCount++;
+        }
+        _nextAxisSlot = (_nextAxisSlot + 1) % _axisSlotCount;
+    }
+    return true;
+}
+
+#pragma endregion
+
+
+#pragma region Public
+
+void OutboundClass::init(KerbalSimpit& simpit, UARTClass& port)
+{
+    _simpit = &simpit;
+    _port = &port;
+    clear();
+}
+
+void OutboundClass::update()
+{
+    if (_simpit == nullptr) return;
+
+    bool done = _flushQueue(_queues[OUTBOUND_SAFETY])
+        && _flushQueue(_queues[OUTBOUND_COMMAND])
+        && (_axisSlotCount == 0 || _flushAxes())
+        && _flushQueue(_queues[OUTBOUND_DIAG]);
+    if (!done) _stallCount++;
+}
+
+void OutboundClass::clear()
+{
+    for (int i = 0; i < OUTBOUND_PRIORITY_COUNT; i++)
+    {
+        _queues[i].head = 0;
+        _queues[i].count = 0;
+    }
+    for (int i = 0; i < _axisSlotCount; i++)
+    {
+        _axisSlots[i].pending = false;
+    }
+}
+
+bool OutboundClass::sendBytes(byte messageType, const byte* msg, byte size, OutboundPriority priority)
+{
+    if (size > OUTBOUND_MAX_PAYLOAD) return false;
+    if (priority == OUTBOUND_AXIS) return sendAxisBytes(messageType, msg, size);
+
+    _OutboundMessage* item = _push(priority);
+    if (item == nullptr) return false;
+    item->op = _OP_SEND;
+    item->arg = messageType;
+    item->size = size;
+    memcpy(item->payload, msg, size);
+    return true;
+}
+
+bool OutboundClass::sendAxisBytes(byte messageType, const byte* msg, byte size)
+{
+    if (size > OUTBOUND_MAX_PAYLOAD) return false;
+
+    // Find the slot for this channel, or take a new one
+    _AxisSlot* slot = nullptr;
+    for (int i = 0; i < _axisSlotCount; i++)
+    {
+        if (_axisSlots[i].messageType == messageType)
+        {
+            slot = &_axisSlots[i];
+            break;
+        }
+    }
+    if (slot == nullptr)
+    {
+        if (_axisSlotCount >= OUTBOUND_AXIS_SLOTS)
+        {
+            _droppedCount++;
+            return false;
+        }
+        slot = &_axisSlots[_axisSlotCount++];
+        slot->messageType = messageType;
+        slot->pending = false;
+    }
+
+    if (slot->pending) _coalescedCount++;
+    slot->size = size;
+    memcpy(slot->payload, msg, size);
+    slot->pending = true;
+
+    byte pending = 0;
+    for (int i = 0; i < _axisSlotCount; i++)
+    {
+        if (_axisSlots[i].pending) pending++;
+    }
+    if (pending > _axisMaxPending) _axisMaxPending = pending;
+    return true;
+}
+
+bool OutboundClass::activateAction(byte action)
+{
+    if (action == STAGE_ACTION || action == ABORT_ACTION)
+    {
+        if (!_pushOp(OUTBOUND_SAFETY, _OP_ACTIVATE, action)) return false;
+        // Do not wait for the next update()
+        update();
+        return true;
+    }
+    return _pushOp(OUTBOUND_COMMAND, _OP_ACTIVATE, action);
+}
+
+bool OutboundClass::deactivateAction(byte action)
+{
+    return _pushOp(OUTBOUND_COMMAND, _OP_DEACTIVATE, action);
+}
+
+bool OutboundClass::toggleCAG(byte actionGroup)
+{
+    return _pushOp(OUTBOUND_COMMAND, _OP_TOGGLE_CAG, actionGroup);
+}
+
+bool OutboundClass::setSASMode(byte mode)
+{
+    return _pushOp(OUTBOUND_COMMAND, _OP_SAS_MODE, mode);
+}
+
+bool OutboundClass::cycleNavBallMode()
+{
+    return _pushOp(OUTBOUND_COMMAND, _OP_NAVBALL, 0);
+}
+
+bool OutboundClass::requestMessageOnChannel(byte channel)
+{
+    return _pushOp(OUTBOUND_COMMAND, _OP_REQUEST, channel);
+}
+
+bool OutboundClass::printToKSP(const char* msg, byte options)
+{
+    // Count the frames first so a long text is never half queued
+    byte pieces = 0;
+    const char* text = msg;
+    do
+    {
+        text += _textPieceLength(text);
+        if (*text == ' ') text++;
+        pieces++;
+    } while (*text != '\0');
+    _OutboundQueue& q = _queues[OUTBOUND_DIAG];
+    if (q.capacity - q.count < pieces)
+    {
+        _droppedCount++;
+        return false;
+    }
+
+    text = msg;
+    for (byte i = 0; i < pieces; i++)
+    {
+        byte length = _textPieceLength(text);
+        _OutboundMessage* item = _push(OUTBOUND_DIAG);
+        item->op = _OP_PRINT;
+        item->arg = options;
+        memcpy(item->text, text, length);
+        item->text[length] = '\0';
+        item->size = length + 1;
+        text += length;
+        if (*text == ' ') text++;
+    }
+    return true;
+}
+
+bool OutboundClass::printToKSP(const String& msg, byte options)
+{
+    return printToKSP(msg.c_str(), options);
+}
+
+void OutboundClass::getStats(OutboundStats& stats)
+{
+    stats.sent = _sentCount;
+    stats.dropped = _droppedCount;
+    stats.coalesced = _coalescedCount;
+    stats.stalls = _stallCount;
+    for (int i = 0; i < OUTBOUND_PRIORITY_COUNT; i++)
+    {
+        stats.depth[i] = _queues[i].count;
+        stats.maxDepth[i] = _queues[i].maxCount;
+        _queues[i].maxCount = _queues[i].count;
+    }
+
+    byte pending = 0;
+    for (int i = 0; i < _axisSlotCount; i++)
+    {
+        if (_axisSlots[i].pending) pending++;
+    }
+    stats.depth[OUTBOUND_AXIS] = pending;
+    stats.maxDepth[OUTBOUND_AXIS] = _axisMaxPending;
+    _axisMaxPending = pending;
+}
+
+#pragma endregion
+
+
+OutboundClass Outbound;
@@ -0,0 +1,95 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Outbound.h
+
+#ifndef _OUTBOUND_h
+#define _OUTBOUND_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+#include <KerbalSimpit.h>
+
+// Queue lengths per priority class
+#define OUTBOUND_SAFETY_SIZE   4
+#define OUTBOUND_COMMAND_SIZE  16
+#define OUTBOUND_DIAG_SIZE     8
+// Channels that can hold a pending axis value (last value wins)
+#define OUTBOUND_AXIS_SLOTS    6
+// Largest payload the queue can hold
+#define OUTBOUND_MAX_PAYLOAD   16
+// Text per print frame. Simpit's payload is 32 bytes: the options byte, the text and its terminator.
+// Longer text is split over several frames.
+#define OUTBOUND_MAX_TEXT      30
+// Bytes a Simpit frame adds around its payload (header, size, type, checksum, framing)
+#define OUTBOUND_FRAME_OVERHEAD 6
+
+// Priority classes, sent in this order
+enum OutboundPriority
+{
+    OUTBOUND_SAFETY,    // Stage, abort
+    OUTBOUND_COMMAND,   // Discrete commands (actions, CAGs, SAS mode, keys, warp)
+    OUTBOUND_AXIS,      // Throttle, rotation, translation, wheel. Only the newest value is sent.
+    OUTBOUND_DIAG,      // Text to KSP
+    OUTBOUND_PRIORITY_COUNT
+};
+
+// Outbound queue figures, see OutboundClass::getStats()
+struct OutboundStats
+{
+    uint32_t sent;                              // Frames written to the serial port
+    uint32_t dropped;                           // Messages lost to a full queue
+    uint32_t coalesced;                         // Axis values replaced before they were sent
+    uint32_t stalls;                            // Updates that stopped early on a full TX buffer
+    byte depth[OUTBOUND_PRIORITY_COUNT];        // Messages waiting per class
+    byte maxDepth[OUTBOUND_PRIORITY_COUNT];     // Deepest each class has been since the last call
+};
+
+class OutboundClass
+{
+public:
+
+	void init(KerbalSimpit& simpit, UARTClass& port);
+	// Send as much as the serial TX buffer has room for, highest priority first
+	void update();
+	// Forget everything that is waiting (e.g. after losing the connection)
+	void clear();
+
+	// Discrete message
+	template <typename T> bool send(byte messageType, T& msg)
+	{
+		return sendBytes(messageType, (byte*)&msg, sizeof(msg), OUTBOUND_COMMAND);
+	}
+	bool sendBytes(byte messageType, const byte* msg, byte size, OutboundPriority priority);
+	// Axis message, replaces any value for the same channel that has not been sent yet
+	template <typename T> bool sendAxis(byte messageType, T& msg)
+	{
+		return sendAxisBytes(messageType, (byte*)&msg, sizeof(msg));
+	}
+	bool sendAxisBytes(byte messageType, const byte* msg, byte size);
+
+	// Simpit library commands. Stage and abort go out as safety messages.
+	bool activateAction(byte action);
+	bool deactivateAction(byte action);
+	bool toggleCAG(byte actionGroup);
+	bool setSASMode(byte mode);
+	bool cycleNavBallMode();
+	bool requestMessageOnChannel(byte channel);
+	// Text longer than OUTBOUND_MAX_TEXT is queued as several prints, all or none of them
+	bool printToKSP(const char* msg, byte options);
+	bool printToKSP(const String& msg, byte options);
+
+	void getStats(OutboundStats& stats);
+};
+
+extern OutboundClass Outbound;
+
+#endif
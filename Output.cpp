@@ -7,25 +7,111 @@
 
 #include <Arduino.h>
 #include "Output.h"
+#include "ShiftChain.h"
 
-int const _SHIFT_OUT_A_DATA_PIN = 2;
-int const _SHIFT_OUT_A_LATCH_PIN = 3;
-int const _SHIFT_OUT_A_CLOCK_PIN = 4;
-int const _SHIFT_OUT_B_DATA_PIN = 5;
-int const _SHIFT_OUT_B_LATCH_PIN = 6;
-int const _SHIFT_OUT_B_CLOCK_PIN = 7;
-int const _SHIFT_OUT_C_DATA_PIN = 8;
-int const _SHIFT_OUT_C_LATCH_PIN = 9;
-int const _SHIFT_OUT_C_CLOCK_PIN = 10;
+// Extra cycles held on each shift clock edge, raise if long wires corrupt the chains
+const int _SHIFT_SETTLE_NOPS = 2;
 
+// 74HC595 chains: registers, data, latch and clock pins, first LED
+typedef ShiftOutChain<8, 2, 3, 4, 0, _SHIFT_SETTLE_NOPS> _ChainA;
+typedef ShiftOutChain<8, 5, 6, 7, _ChainA::END, _SHIFT_SETTLE_NOPS> _ChainB;
+typedef ShiftOutChain<1, 8, 9, 10, _ChainB::END, _SHIFT_SETTLE_NOPS> _ChainC;
+typedef ShiftOutChains<_ChainA, _ChainB, _ChainC> _Chains;
+
+// LEDs on Arduino pins, after the chains
 int const ARDUINO_PINS[10] = {22,23,24,25,26,27,28,29,30,31};
+const int _FIRST_DIRECT_LED = _Chains::END;
+static_assert(_FIRST_DIRECT_LED + 10 - 1 == TOTAL_LEDS, "TOTAL_LEDS does not match the output chains");
+
+// Wired so that they light when their bit is low
+const int _INVERTED_LEDS[] = { 111, 112 };
+
+// Where each LED lives in a bit plane: bit of the chain buffer, or _DIRECT_BIT + Arduino pin index
+const uint16_t _DIRECT_BIT = 0x8000;
+
+constexpr uint16_t _ledBitOf(int pin)
+{
+    return pin < _FIRST_DIRECT_LED ? _Chains::bitIndex(pin) : _DIRECT_BIT + (pin - _FIRST_DIRECT_LED);
+}
+
+/// <summary>True if a chain drives every LED from pin up to the first direct LED. bitIndex() is -1
+/// for a gap between chains, which _ledBitOf() would turn into a bogus direct bit.</summary>
+constexpr bool _chainsCoverLEDs(int pin)
+{
+    return pin >= _FIRST_DIRECT_LED || (_Chains::bitIndex(pin) >= 0 && _chainsCoverLEDs(pin + 1));
+}
+static_assert(_chainsCoverLEDs(0), "An LED before the direct pins is not on any output chain");
+
+// _ledBitOf() for every LED, built by the compiler
+template <typename PINS>
+struct _LEDBitTable;
+
+template <int... PINS>
+struct _LEDBitTable<ShiftIndexList<PINS...> >
+{
+    static constexpr uint16_t BITS[sizeof...(PINS)] = { _ledBitOf(PINS)... };
+};
+
+template <int... PINS>
+constexpr uint16_t _LEDBitTable<ShiftIndexList<PINS...> >::BITS[sizeof...(PINS)];
+
+typedef _LEDBitTable<MakeShiftIndexList<TOTAL_LEDS + 1>::Type> _LEDBits;
+
+// LED brightness levels (0 - LED_MAX_BRIGHTNESS), indexed by LED pin
+volatile byte _ledLevel[TOTAL_LEDS + 1] = { 0 };
+volatile bool _levelsDirty = true;              // A level changed since the back planes were built
+byte _globalBrightness = LED_MAX_BRIGHTNESS;
+byte _scaledLevel[LED_MAX_BRIGHTNESS + 1];      // Level after global brightness
+
+// Bit-angle modulation: one bit plane per brightness bit, plane N is shown for 2^N time units
+struct BitPlane
+{
+    byte chains[_Chains::BYTES];
+    uint16_t direct;            // Arduino pins, bit N = ARDUINO_PINS[N]
+};
+// Two sets of planes: the interrupt shows the front set while updateLEDs() builds the back one,
+// and they are swapped at the next frame start
+BitPlane _planes[2][LED_BRIGHTNESS_BITS];
+volatile byte _frontPlanes = 0;
+volatile bool _backPlanesReady = false;
+BitPlane _invertMask;           // Bits of _INVERTED_LEDS, flipped in every plane
+volatile byte _bamPlane = 0;
+
+// Refresh timer: TC1 channel 1 (TC4 interrupt), clocked from MCK/8
+#define _REFRESH_TC TC1
+#define _REFRESH_TC_CHANNEL 1
+#define _REFRESH_TC_IRQ TC4_IRQn
+#define _REFRESH_TC_ID ID_TC4
+// Below the tone generator (Sound.cpp), above the input capture (Input.cpp)
+const uint32_t _REFRESH_IRQ_PRIORITY = 4;
+const uint32_t _BAM_UNIT_TICKS = VARIANT_MCK / 8 / (BAM_FRAME_HZ * ((1 << LED_BRIGHTNESS_BITS) - 1));
+const uint32_t _FRAMES_PER_EFFECT_TICK = BAM_FRAME_HZ / LED_EFFECT_TICK_HZ;
 
-// Shift out pins
-bool _sA[64] = { 0 };
-bool _sB[64] = { 0 };
-bool _sC[8]  = { 0 };
+// Refresh statistics, see getRefreshStats()
+volatile uint32_t _frameCount = 0;
+volatile uint32_t _isrCycles = 0;
+volatile uint32_t _isrMaxCycles = 0;
+uint32_t _statsLastFrameCount = 0;
+uint32_t _statsLastIsrCycles = 0;
+uint32_t _statsLastCycle = 0;
 
-bool arduinoPinsOutput[10] = { 0 };
+// Port and mask of the direct LED pins for writes from the interrupt
+FastPin _directLEDPins[10];
+
+// LED effects, ticked from the refresh interrupt
+const byte _NO_EFFECT = 0xFF;
+
+struct LEDEffect
+{
+    byte pin;
+    LEDPattern pattern;
+    uint16_t periodTicks;
+    bool active;
+};
+
+volatile LEDEffect _ledEffects[MAX_LED_EFFECTS];
+volatile byte _ledEffectSlot[TOTAL_LEDS + 1];   // Effect index per LED, _NO_EFFECT if none
+volatile uint32_t _effectTick = 0;              // Shared phase clock for every effect
 
 // Heading LCD
 LiquidCrystal_I2C _headingLCD(0x23, 16, 2); // I2C address 0x23, 16 column and 2 rows
@@ -54,66 +140,178 @@ String _lastHeadingTop, _lastHeadingBot;
 String _directionLCDTopTxt, _directionLCDBotTxt;
 String _lastDirectionTop, _lastDirectionBot;
 
+// Glyph bitmaps, 5x8 pixels, indexed by LCDGlyph (which is also the CGRAM slot)
+byte _glyphBitmaps[GLYPH_COUNT][8] = {
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },    // Bar 1
+    { 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 },    // Bar 2
+    { 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C },    // Bar 3
+    { 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E },    // Bar 4
+    { 0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00 },    // Arrow up
+    { 0x04, 0x04, 0x04, 0x04, 0x15, 0x0E, 0x04, 0x00 },    // Arrow down
+    { 0x00, 0x04, 0x0E, 0x1B, 0x0E, 0x00, 0x00, 0x00 }     // Prograde
+};
+// CGRAM 0-7 is mirrored at 8-15, printing from 8 keeps a '\0' out of the Strings
+const byte _GLYPH_CHAR_BASE = 8;
+// Glyphs each display has loaded, one bit per LCDGlyph
+byte _speedGlyphs = 0;
+byte _altitudeGlyphs = 0;
+byte _infoGlyphs = 0;
+byte _headingGlyphs = 0;
+byte _directionGlyphs = 0;
+
 
-void _sendShiftOut(bool states[], int size, int dataPin, int latchPin, int clockPin)
+/// <summary>Set an LED's bit in a bit plane.</summary>
+inline void _setPlaneBit(BitPlane& plane, int pin)
 {
-    // Define outputA (4 bytes)
-    unsigned long outputA = 0;
-    // Define outputB (4 bytes)
-    unsigned long outputB = 0;
+    uint16_t bit = _LEDBits::BITS[pin];
+    if (bit & _DIRECT_BIT)
+        bitSet(plane.direct, bit & ~_DIRECT_BIT);
+    else
+        bitSet(plane.chains[bit / 8], bit % 8);
+}
 
-    // For each pin/bit
-    for (int pin = 0; pin < size; pin++)
+/// <summary>Collect the bits of the inverted LEDs.</summary>
+void _buildInvertMask()
+{
+    memset(&_invertMask, 0, sizeof(_invertMask));
+    for (unsigned int i = 0; i < sizeof(_INVERTED_LEDS) / sizeof(int); i++)
+    {
+        _setPlaneBit(_invertMask, _INVERTED_LEDS[i]);
+    }
+}
+
+/// <summary>Recompute the global brightness lookup.</summary>
+void _buildScaledLevels()
+{
+    for (int i = 0; i <= LED_MAX_BRIGHTNESS; i++)
+    {
+        _scaledLevel[i] = (i * _globalBrightness + LED_MAX_BRIGHTNESS / 2) / LED_MAX_BRIGHTNESS;
+    }
+}
+
+/// <summary>Build a set of bit planes from the LED levels.</summary>
+void _buildBitPlanes(BitPlane planes[LED_BRIGHTNESS_BITS])
+{
+    memset(planes, 0, sizeof(BitPlane) * LED_BRIGHTNESS_BITS);
+    for (int pin = 0; pin <= TOTAL_LEDS; pin++)
     {
-        // First 4 bytes
-        if (pin <= 31 && states[pin] == 1)
+        byte level = _scaledLevel[_ledLevel[pin]];
+        if (level == 0) continue;
+
+        for (int plane = 0; plane < LED_BRIGHTNESS_BITS; plane++)
         {
-            // Set the value for THIS pin/bit to 1 in reverse order
-            bitSet(outputA, pin);
+            if (bitRead(level, plane))
+                _setPlaneBit(planes[plane], pin);
         }
-        // Last 4 bytes
-        else if (states[pin] == 1)
+    }
+    // MAX - level has exactly the other bits set, so an inverted LED is its bits flipped in every plane
+    for (int plane = 0; plane < LED_BRIGHTNESS_BITS; plane++)
+    {
+        for (int i = 0; i < _Chains::BYTES; i++)
         {
-            // Set the value for THIS pin/bit to 1 in reverse order
-            bitSet(outputB, pin - 32);
+            planes[plane].chains[i] ^= _invertMask.chains[i];
         }
+        planes[plane].direct ^= _invertMask.direct;
+    }
+}
+
+/// <summary>Set a static LED level, shown once updateLEDs() has built the planes.</summary>
+void _writeLED(int pin, byte level)
+{
+    if (_ledLevel[pin] == level) return;
+    _ledLevel[pin] = level;
+    _levelsDirty = true;
+}
+
+/// <summary>Remove any effect from an LED.</summary>
+void _clearEffect(int pin)
+{
+    byte slot = _ledEffectSlot[pin];
+    if (slot == _NO_EFFECT) return;
+    // Stop the tick from touching this LED before the caller writes it
+    _ledEffects[slot].active = false;
+    _ledEffectSlot[pin] = _NO_EFFECT;
+    // The shown planes hold the effect's last bits for it, rebuild them from the static level
+    _levelsDirty = true;
+}
+
+/// <summary>Level of a pattern at a point in its period.</summary>
+byte _patternLevel(LEDPattern pattern, uint16_t periodTicks, uint32_t tick)
+{
+    uint32_t phase = tick % periodTicks;
+    byte eighth = (phase * 8) / periodTicks;
+    switch (pattern)
+    {
+    case LED_SOLID:        return LED_MAX_BRIGHTNESS;
+    case LED_BLINK:        return phase < periodTicks / 2 ? LED_MAX_BRIGHTNESS : 0;
+    case LED_DOUBLE_FLASH: return (eighth == 0 || eighth == 2) ? LED_MAX_BRIGHTNESS : 0;
+    case LED_PULSE:
+    {
+        // Triangle ramp up then down over the period. The down half is the longer one for an odd
+        // period, each side is scaled by its own length so the peak stays at LED_MAX_BRIGHTNESS.
+        uint32_t half = periodTicks / 2;
+        if (phase < half)
+            return (phase * LED_MAX_BRIGHTNESS) / half;
+        return ((periodTicks - phase) * LED_MAX_BRIGHTNESS) / (periodTicks - half);
+    }
+    default:               return 0;
+    }
+}
+
+/// <summary>Write an LED's bits for a level into a set of bit planes, scaled by the global brightness
+/// and flipped for an inverted LED.</summary>
+void _patchLED(BitPlane planes[LED_BRIGHTNESS_BITS], int pin, byte level)
+{
+    byte scaled = _scaledLevel[level];
+    uint16_t bit = _LEDBits::BITS[pin];
+    bool isDirect = bit & _DIRECT_BIT;
+    bit &= ~_DIRECT_BIT;
+    bool inverted = isDirect ? bitRead(_invertMask.direct, bit) : bitRead(_invertMask.chains[bit / 8], bit % 8);
+    for (int plane = 0; plane < LED_BRIGHTNESS_BITS; plane++)
+    {
+        bool on = bitRead(scaled, plane) != inverted;
+        if (isDirect)
+            bitWrite(planes[plane].direct, bit, on);
+        else
+            bitWrite(planes[plane].chains[bit / 8], bit % 8, on);
     }
+}
 
-    // Break down the bytes 4-2 bytes
-    unsigned int b0_1 = int(outputA);
-    unsigned int b2_3 = int(outputA >> 16);
-    unsigned int b4_5 = int(outputB);
-    unsigned int b6_7 = int(outputB >> 16);
-
-    // Break down the bytes 2-1 bytes
-    byte b0 = lowByte(b0_1);
-    byte b1 = highByte(b0_1);
-    byte b2 = lowByte(b2_3);
-    byte b3 = highByte(b2_3);
-    byte b4 = lowByte(b4_5);
-    byte b5 = highByte(b4_5);
-    byte b6 = lowByte(b6_7);
-    byte b7 = highByte(b6_7);
-    // Disable
-    digitalWrite(latchPin, LOW);
-    // Shift the values into the register starting from the first register
-    shiftOut(dataPin, clockPin, MSBFIRST, b7);
-    shiftOut(dataPin, clockPin, MSBFIRST, b6);
-    shiftOut(dataPin, clockPin, MSBFIRST, b5);
-    shiftOut(dataPin, clockPin, MSBFIRST, b4);
-    shiftOut(dataPin, clockPin, MSBFIRST, b3);
-    shiftOut(dataPin, clockPin, MSBFIRST, b2);
-    shiftOut(dataPin, clockPin, MSBFIRST, b1);
-    shiftOut(dataPin, clockPin, MSBFIRST, b0);
-    // Enable
-    digitalWrite(latchPin, HIGH);
-}
-
-void _sendLCD(LiquidCrystal_I2C &lcd, String &lastLine1, String &lastLine2, String newLine1, String newLine2)
+/// <summary>Patch every LED with an effect into a set of bit planes, at the current effect tick.</summary>
+void _applyEffects(BitPlane planes[LED_BRIGHTNESS_BITS])
+{
+    uint32_t tick = _effectTick;
+    for (int i = 0; i < MAX_LED_EFFECTS; i++)
+    {
+        if (!_ledEffects[i].active) continue;
+        _patchLED(planes, _ledEffects[i].pin, _patternLevel(_ledEffects[i].pattern, _ledEffects[i].periodTicks, tick));
+    }
+}
+
+/// <summary>Upload the glyphs a line uses that the display does not have yet.</summary>
+void _loadGlyphs(LiquidCrystal_I2C &lcd, byte &loaded, const String &text)
+{
+    for (unsigned int i = 0; i < text.length(); i++)
+    {
+        byte c = text[i];
+        if (c < _GLYPH_CHAR_BASE || c >= _GLYPH_CHAR_BASE + GLYPH_COUNT)
+            continue;
+        byte slot = c - _GLYPH_CHAR_BASE;
+        if (bitRead(loaded, slot))
+            continue;
+        lcd.createChar(slot, _glyphBitmaps[slot]);
+        bitSet(loaded, slot);
+    }
+}
+
+void _sendLCD(LiquidCrystal_I2C &lcd, byte &glyphsLoaded, String &lastLine1, String &lastLine2, String newLine1, String newLine2)
 {
     // Only update if text changed
     if (lastLine1 != newLine1 || lastLine2 != newLine2)
     {
+        // Custom characters first, uploading one leaves the LCD addressing CGRAM until the clear
+        _loadGlyphs(lcd, glyphsLoaded, newLine1);
+        _loadGlyphs(lcd, glyphsLoaded, newLine2);
         // Clear LCD only if needed
         lcd.clear();
         // Print to top line
@@ -146,62 +344,229 @@ void OutputClass::init()
     setInfoLCD("INFO TEST", "INFO TEST");
 
     // Shift register pins
-    pinMode(_SHIFT_OUT_A_DATA_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_A_LATCH_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_A_CLOCK_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_B_DATA_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_B_LATCH_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_B_CLOCK_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_C_DATA_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_C_LATCH_PIN, OUTPUT);
-    pinMode(_SHIFT_OUT_C_CLOCK_PIN, OUTPUT);
-
-	for (auto pin : ARDUINO_PINS)
+    _Chains::begin();
+
+	for (int i = 0; i < 10; i++)
 	{
-		pinMode(pin, OUTPUT);
+		pinMode(ARDUINO_PINS[i], OUTPUT);
+		_directLEDPins[i] = fastPin(ARDUINO_PINS[i]);
 	}
+    _buildInvertMask();
 
-    _sendShiftOut(_sA, 64, _SHIFT_OUT_A_DATA_PIN, _SHIFT_OUT_A_LATCH_PIN, _SHIFT_OUT_A_CLOCK_PIN);
-    _sendShiftOut(_sB, 64, _SHIFT_OUT_B_DATA_PIN, _SHIFT_OUT_B_LATCH_PIN, _SHIFT_OUT_B_CLOCK_PIN);
-    _sendShiftOut(_sC, 8, _SHIFT_OUT_C_DATA_PIN, _SHIFT_OUT_C_LATCH_PIN, _SHIFT_OUT_C_CLOCK_PIN);
-    
+    // LED effects
+    for (int i = 0; i <= TOTAL_LEDS; i++)
+    {
+        _ledEffectSlot[i] = _NO_EFFECT;
+    }
+    for (int i = 0; i < MAX_LED_EFFECTS; i++)
+    {
+        _ledEffects[i].active = false;
+    }
+
+    _buildScaledLevels();
+    _buildBitPlanes(_planes[_frontPlanes]);
+    _levelsDirty = false;
+
+    // Cycle counter for refresh statistics
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    _statsLastCycle = DWT->CYCCNT;
+
+    // Refresh interrupt, first plane is shown for one time unit
+    pmc_set_writeprotect(false);
+    pmc_enable_periph_clk(_REFRESH_TC_ID);
+    TC_Configure(_REFRESH_TC, _REFRESH_TC_CHANNEL, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK2);
+    TC_SetRC(_REFRESH_TC, _REFRESH_TC_CHANNEL, _BAM_UNIT_TICKS);
+    _REFRESH_TC->TC_CHANNEL[_REFRESH_TC_CHANNEL].TC_IER = TC_IER_CPCS;
+    _REFRESH_TC->TC_CHANNEL[_REFRESH_TC_CHANNEL].TC_IDR = ~TC_IER_CPCS;
+    NVIC_SetPriority(_REFRESH_TC_IRQ, _REFRESH_IRQ_PRIORITY);
+    NVIC_EnableIRQ(_REFRESH_TC_IRQ);
+    TC_Start(_REFRESH_TC, _REFRESH_TC_CHANNEL);
 }
 /// <summary>Update the controller outputs.</summary>
 void OutputClass::update()
 {
     
-    _sendLCD(_speedLCD, _lastSpeedTop, _lastSpeedBot, _speedLCDTopTxt, _speedLCDBotTxt);
-    _sendLCD(_altitudeLCD, _lastAltitudeTop, _lastAltitudeBot, _altitudeLCDTopTxt, _altitudeLCDBotTxt);
-    _sendLCD(_headingLCD, _lastHeadingTop, _lastHeadingBot, _headingLCDTopTxt, _headingLCDBotTxt);
-    _sendLCD(_infoLCD, _lastInfoTop, _lastInfoBot, _infoLCDTopTxt, _infoLCDBotTxt);
-    _sendLCD(_directionLCD, _lastDirectionTop, _lastDirectionBot, _directionLCDTopTxt, _directionLCDBotTxt);
-    
-    _sendShiftOut(_sA, 64, _SHIFT_OUT_A_DATA_PIN, _SHIFT_OUT_A_LATCH_PIN, _SHIFT_OUT_A_CLOCK_PIN);
-    _sendShiftOut(_sB, 64, _SHIFT_OUT_B_DATA_PIN, _SHIFT_OUT_B_LATCH_PIN, _SHIFT_OUT_B_CLOCK_PIN);
-    _sendShiftOut(_sC, 8, _SHIFT_OUT_C_DATA_PIN, _SHIFT_OUT_C_LATCH_PIN, _SHIFT_OUT_C_CLOCK_PIN);
-    for (auto pin : ARDUINO_PINS)
-	{
-		digitalWrite(pin, arduinoPinsOutput[pin - 22]);
-	}
+    _sendLCD(_speedLCD, _speedGlyphs, _lastSpeedTop, _lastSpeedBot, _speedLCDTopTxt, _speedLCDBotTxt);
+    _sendLCD(_altitudeLCD, _altitudeGlyphs, _lastAltitudeTop, _lastAltitudeBot, _altitudeLCDTopTxt, _altitudeLCDBotTxt);
+    _sendLCD(_headingLCD, _headingGlyphs, _lastHeadingTop, _lastHeadingBot, _headingLCDTopTxt, _headingLCDBotTxt);
+    _sendLCD(_infoLCD, _infoGlyphs, _lastInfoTop, _lastInfoBot, _infoLCDTopTxt, _infoLCDBotTxt);
+    _sendLCD(_directionLCD, _directionGlyphs, _lastDirectionTop, _lastDirectionBot, _directionLCDTopTxt, _directionLCDBotTxt);
+    updateLEDs();
+}
+
+/// <summary>Build the back bit planes if a static LED level has changed. The refresh interrupt swaps them
+/// in at its next frame start, so no frame ever shows half built planes.</summary>
+void OutputClass::updateLEDs()
+{
+    // Still waiting for the interrupt to take the last set
+    if (!_levelsDirty || _backPlanesReady) return;
+    // Cleared first, a level written while building marks the planes dirty again
+    _levelsDirty = false;
+    _buildBitPlanes(_planes[_frontPlanes ^ 1]);
+    // Planes written out before the interrupt can see them as ready
+    __DMB();
+    _backPlanesReady = true;
 }
 
 void OutputClass::setLED(int pin, bool state)
 {
-	// edge case, need to flip dont ask why. It was easier to do this then try and dig through the wires...
-	if (pin == 111 || pin == 112)
-		state = !state;
-		
-	if (pin < 64)
-	    _sA[pin] = state;
-	else if (pin < 128)
-		_sB[pin - 64] = state;
-	else if (pin < 136)
-	    _sC[pin - 128] = state;
-	else if (pin <= TOTAL_LEDS) // Not on shift register, on arduino
-		arduinoPinsOutput[pin - 136] = state;
+    setLEDBrightness(pin, state ? LED_MAX_BRIGHTNESS : 0);
+}
+
+void OutputClass::setLEDBrightness(int pin, byte level)
+{
+    if (pin < 0 || pin > TOTAL_LEDS) return;
+    if (level > LED_MAX_BRIGHTNESS) level = LED_MAX_BRIGHTNESS;
+    _clearEffect(pin);
+    _writeLED(pin, level);
+}
+
+void OutputClass::setGlobalBrightness(byte level)
+{
+    if (level > LED_MAX_BRIGHTNESS) level = LED_MAX_BRIGHTNESS;
+    if (level == _globalBrightness) return;
+    _globalBrightness = level;
+    _buildScaledLevels();
+    _levelsDirty = true;
+}
+
+byte OutputClass::getGlobalBrightness()
+{
+    return _globalBrightness;
+}
+
+void OutputClass::setLEDPattern(int pin, LEDPattern pattern, unsigned int periodMs)
+{
+    if (pin < 0 || pin > TOTAL_LEDS) return;
+    if (pattern == LED_OFF || pattern == LED_SOLID)
+    {
+        setLED(pin, pattern == LED_SOLID);
+        return;
+    }
+
+    uint16_t periodTicks = (uint32_t)periodMs * LED_EFFECT_TICK_HZ / 1000;
+    if (periodTicks < 2) periodTicks = 2;
+
+    byte slot = _ledEffectSlot[pin];
+    if (slot != _NO_EFFECT)
+    {
+        // Same pattern already running, keep its phase
+        if (_ledEffects[slot].pattern == pattern && _ledEffects[slot].periodTicks == periodTicks) return;
+        _ledEffects[slot].active = false;
+    }
+    else
+    {
+        // Find a free slot
+        for (slot = 0; slot < MAX_LED_EFFECTS; slot++)
+        {
+            if (!_ledEffects[slot].active) break;
+        }
+        if (slot >= MAX_LED_EFFECTS) return; // Table full, leave the LED as is
+    }
+
+    _ledEffects[slot].pin = pin;
+    _ledEffects[slot].pattern = pattern;
+    _ledEffects[slot].periodTicks = periodTicks;
+    _ledEffectSlot[pin] = slot;
+    // The refresh interrupt patches it into the shown planes from the next effect tick
+    _ledEffects[slot].active = true;
+}
+
+/// <summary>Advance the shared effect clock and patch every active pattern into the planes being shown.
+/// Effects never wait for updateLEDs(), so they keep their timing while the loop is busy.</summary>
+void OutputClass::tickEffects()
+{
+    _effectTick++;
+    _applyEffects(_planes[_frontPlanes]);
+}
+
+/// <summary>Show the next bit plane. Runs LED_BRIGHTNESS_BITS times per frame, each plane
+/// stays latched for twice as long as the one before it.</summary>
+void OutputClass::refreshISR()
+{
+    uint32_t start = DWT->CYCCNT;
+    byte plane = _bamPlane;
+
+    if (plane == 0)
+    {
+        // Frame start: take the new planes if updateLEDs() has built them, then step the effects
+        _frameCount++;
+        bool swapped = _backPlanesReady;
+        if (swapped)
+        {
+            _frontPlanes ^= 1;
+            _backPlanesReady = false;
+        }
+        if (_frameCount % _FRAMES_PER_EFFECT_TICK == 0)
+            tickEffects();
+        else if (swapped)
+            _applyEffects(_planes[_frontPlanes]);      // Built from the static levels only
+    }
+
+    const BitPlane& p = _planes[_frontPlanes][plane];
+    _Chains::send(p.chains);
+    for (int i = 0; i < 10; i++)
+    {
+        fastWrite(_directLEDPins[i], bitRead(p.direct, i));
+    }
+
+    // Time until the next plane, counter restarted at the compare that raised this interrupt
+    _REFRESH_TC->TC_CHANNEL[_REFRESH_TC_CHANNEL].TC_RC = _BAM_UNIT_TICKS << plane;
+    _bamPlane = (plane + 1 >= LED_BRIGHTNESS_BITS) ? 0 : plane + 1;
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    _isrCycles += cycles;
+    if (cycles > _isrMaxCycles) _isrMaxCycles = cycles;
+}
+
+void OutputClass::getRefreshStats(OutputRefreshStats& stats)
+{
+    uint32_t now = DWT->CYCCNT;
+    uint32_t frames = _frameCount;
+    uint32_t isrCycles = _isrCycles;
+    uint32_t elapsed = now - _statsLastCycle;
+
+    stats.frameRateHz = elapsed ? (uint64_t)(frames - _statsLastFrameCount) * VARIANT_MCK / elapsed : 0;
+    stats.cpuLoadPermille = elapsed ? (uint64_t)(isrCycles - _statsLastIsrCycles) * 1000 / elapsed : 0;
+    stats.maxIsrMicros = _isrMaxCycles / (VARIANT_MCK / 1000000);
+
+    _statsLastCycle = now;
+    _statsLastFrameCount = frames;
+    _statsLastIsrCycles = isrCycles;
+    _isrMaxCycles = 0;
+}
+
+void TC4_Handler()
+{
+    TC_GetStatus(_REFRESH_TC, _REFRESH_TC_CHANNEL);
+    Output.refreshISR();
 }
 
 // Displays
+char OutputClass::glyphChar(LCDGlyph glyph)
+{
+    return (char)(_GLYPH_CHAR_BASE + glyph);
+}
+
+String OutputClass::barGraph(byte width, long value, long full)
+{
+    if (full <= 0) full = 1;
+    value = constrain(value, 0, full);
+    // Filled pixel columns, 5 per character
+    long columns = (long)((int64_t)value * width * 5 / full);
+
+    String bar = "";
+    for (byte i = 0; i < width; i++)
+    {
+        long cell = columns - i * 5;
+        if (cell >= 5) bar += LCD_FULL_BLOCK_CHAR;
+        else if (cell <= 0) bar += ' ';
+        else bar += glyphChar((LCDGlyph)(GLYPH_BAR_1 + cell - 1));
+    }
+    return bar;
+}
+
 void OutputClass::setSpeedLCD(String top, String bot)
 {
     _speedLCDTopTxt = top;
@@ -165,6 +165,48 @@
 #define ELECTRICITY_LED_20  65
 
 
+// LED dimming (bit-angle modulation over the shift-register chains)
+#define LED_BRIGHTNESS_BITS 4                               // Bits of brightness per LED
+#define LED_MAX_BRIGHTNESS  ((1 << LED_BRIGHTNESS_BITS) - 1)
+#define BAM_FRAME_HZ        250                             // Full brightness cycles per second
+
+// LED effects
+#define LED_EFFECT_TICK_HZ (BAM_FRAME_HZ / 2)   // Effect tick rate, driven by the refresh interrupt
+#define MAX_LED_EFFECTS    16                   // LEDs that can run a pattern at the same time
+
+enum LEDPattern
+{
+    LED_OFF,
+    LED_SOLID,
+    LED_BLINK,          // On for the first half of the period
+    LED_DOUBLE_FLASH,   // Two short flashes per period
+    LED_PULSE           // Fade up and down once per period
+};
+
+// LCD custom characters. A glyph always uses the same CGRAM slot and is uploaded to a
+// display the first time text sent to that display contains it.
+enum LCDGlyph
+{
+    GLYPH_BAR_1,        // Bar segments, 1 to 4 of the 5 pixel columns filled
+    GLYPH_BAR_2,
+    GLYPH_BAR_3,
+    GLYPH_BAR_4,
+    GLYPH_ARROW_UP,
+    GLYPH_ARROW_DOWN,
+    GLYPH_PROGRADE,     // Navball prograde marker
+    GLYPH_COUNT         // At most 8
+};
+// Solid cell from the LCD character ROM
+#define LCD_FULL_BLOCK_CHAR ((char)255)
+
+// Measured LED refresh figures, see OutputClass::getRefreshStats()
+struct OutputRefreshStats
+{
+    uint32_t frameRateHz;       // Full BAM frames per second
+    uint32_t cpuLoadPermille;   // Share of CPU time spent in the refresh interrupt (1/1000)
+    uint32_t maxIsrMicros;      // Longest single refresh interrupt
+};
+
 #if defined(ARDUINO) && ARDUINO >= 100
     #include "Arduino.h" 
 #else
@@ -179,17 +221,36 @@ protected:
 public:
 
 	void init();
+	// Send changed LCD text and LED levels
 	void update();
+	// Only the static LED levels, e.g. while the loop is idle. Effects run from the refresh interrupt.
+	void updateLEDs();
 
 	void setLED(int pin, bool state);
+	// Brightness 0 - LED_MAX_BRIGHTNESS
+	void setLEDBrightness(int pin, byte level);
+	// Scales every LED, 0 - LED_MAX_BRIGHTNESS
+	void setGlobalBrightness(byte level);
+	byte getGlobalBrightness();
+	// Assign a pattern to an LED. Patterns with the same period stay phase aligned.
+	// Re-assigning the same pattern is a no-op, so this is safe to call every loop.
+	void setLEDPattern(int pin, LEDPattern pattern, unsigned int periodMs);
+	// Effect tick, called from the refresh interrupt. Patches the effect LEDs into the shown planes.
+	void tickEffects();
+	// BAM refresh, called from the timer interrupt
+	void refreshISR();
+	// Refresh rate and interrupt load since the last call
+	void getRefreshStats(OutputRefreshStats& stats);
 	// Displays
+	// Character for a glyph, usable in any LCD text
+	char glyphChar(LCDGlyph glyph);
+	// Bar of value/full, width characters with 5 steps each
+	String barGraph(byte width, long value, long full);
 	void setSpeedLCD(String top, String bot);
 	void setAltitudeLCD(String top, String bot);
 	void setHeadingLCD(String top, String bot);
 	void setDirectionLCD(String top, String bot);
 	void setInfoLCD(String top, String bot);
-	// Sound
-	void setSound(int frequency, bool enabled);
 };
 
 extern OutputClass Output;
@@ -0,0 +1,387 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// ShiftChain.h
+// 74HC165 input and 74HC595 output chains described at compile time. Length, pins and the first
+// virtual pin or LED of a chain are template arguments, so every transfer is unrolled and every
+// table is sized statically. A new board is one more chain in the ShiftInChains/ShiftOutChains list.
+
+#ifndef _SHIFTCHAIN_h
+#define _SHIFTCHAIN_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+#include <variant.h>
+
+// Forces the unrolled transfer steps inline, -Os would otherwise call them one bit at a time
+#define SHIFT_CHAIN_INLINE inline __attribute__((always_inline))
+
+// 74HC165 parallel load pulse and the wait after it before clocking, in microseconds. The parts
+// need far less, this is the margin the boards have always run with on their long wires.
+#define SHIFT_IN_LOAD_MICROS 5
+
+// Port and mask of a pin for direct register access, safe from interrupts
+struct FastPin
+{
+    Pio* port;
+    uint32_t mask;
+};
+
+inline FastPin fastPin(int pin)
+{
+    FastPin fp;
+    fp.port = g_APinDescription[pin].pPort;
+    fp.mask = g_APinDescription[pin].ulPin;
+    return fp;
+}
+
+SHIFT_CHAIN_INLINE void fastWrite(const FastPin& pin, bool state)
+{
+    if (state) pin.port->PIO_SODR = pin.mask;
+    else pin.port->PIO_CODR = pin.mask;
+}
+
+SHIFT_CHAIN_INLINE bool fastRead(const FastPin& pin)
+{
+    return (pin.port->PIO_PDSR & pin.mask) != 0;
+}
+
+#pragma region Compile-time tables
+
+// 0 to N - 1 as a template argument pack, for building constant tables:
+// template <int... I> ... TABLE[] = { f(I)... }; with MakeShiftIndexList<N>::Type
+template <int... I>
+struct ShiftIndexList {};
+
+template <int N, int... I>
+struct MakeShiftIndexList : MakeShiftIndexList<N - 1, N - 1, I...> {};
+template <int... I>
+struct MakeShiftIndexList<0, I...>
+{
+    typedef ShiftIndexList<I...> Type;
+};
+
+#pragma endregion
+
+#pragma region Unrolled steps
+
+// NOPS cycles of delay, for clock edges that need to be held or settle
+template <int NOPS>
+struct ShiftSettle
+{
+    static SHIFT_CHAIN_INLINE void wait()
+    {
+        __asm__ volatile("nop");
+        ShiftSettle<NOPS - 1>::wait();
+    }
+};
+template <>
+struct ShiftSettle<0>
+{
+    static SHIFT_CHAIN_INLINE void wait() {}
+};
+
+// Bits BIT down to 0 of a byte out to a 74HC595, MSB first
+template <int BIT, int NOPS>
+struct ShiftOutBits
+{
+    static SHIFT_CHAIN_INLINE void send(const FastPin& data, const FastPin& clock, byte value)
+    {
+        fastWrite(data, (value >> BIT) & 1);
+        ShiftSettle<NOPS>::wait();
+        fastWrite(clock, HIGH);
+        ShiftSettle<NOPS>::wait();
+        fastWrite(clock, LOW);
+        ShiftOutBits<BIT - 1, NOPS>::send(data, clock, value);
+    }
+};
+template <int NOPS>
+struct ShiftOutBits<-1, NOPS>
+{
+    static SHIFT_CHAIN_INLINE void send(const FastPin&, const FastPin&, byte) {}
+};
+
+// Bytes INDEX down to 0, the last byte goes first so it ends up in the furthest register
+template <int INDEX, int NOPS>
+struct ShiftOutBytes
+{
+    static SHIFT_CHAIN_INLINE void send(const FastPin& data, const FastPin& clock, const byte bytes[])
+    {
+        ShiftOutBits<7, NOPS>::send(data, clock, bytes[INDEX]);
+        ShiftOutBytes<INDEX - 1, NOPS>::send(data, clock, bytes);
+    }
+};
+template <int NOPS>
+struct ShiftOutBytes<-1, NOPS>
+{
+    static SHIFT_CHAIN_INLINE void send(const FastPin&, const FastPin&, const byte[]) {}
+};
+
+// Bits BIT up to 7 of a byte in from a 74HC165, LSB first
+template <int BIT, int NOPS>
+struct ShiftInBits
+{
+    static SHIFT_CHAIN_INLINE byte read(const FastPin& clock, const FastPin& data, byte value)
+    {
+        fastWrite(clock, HIGH);
+        ShiftSettle<NOPS>::wait();
+        if (fastRead(data)) value |= 1 << BIT;
+        fastWrite(clock, LOW);
+        ShiftSettle<NOPS>::wait();
+        return ShiftInBits<BIT + 1, NOPS>::read(clock, data, value);
+    }
+};
+template <int NOPS>
+struct ShiftInBits<8, NOPS>
+{
+    static SHIFT_CHAIN_INLINE byte read(const FastPin&, const FastPin&, byte value) { return value; }
+};
+
+// Bytes INDEX up to COUNT - 1
+template <int INDEX, int COUNT, int NOPS>
+struct ShiftInBytes
+{
+    static SHIFT_CHAIN_INLINE void read(const FastPin& clock, const FastPin& data, byte bytes[])
+    {
+        bytes[INDEX] = ShiftInBits<0, NOPS>::read(clock, data, 0);
+        ShiftInBytes<INDEX + 1, COUNT, NOPS>::read(clock, data, bytes);
+    }
+};
+template <int COUNT, int NOPS>
+struct ShiftInBytes<COUNT, COUNT, NOPS>
+{
+    static SHIFT_CHAIN_INLINE void read(const FastPin&, const FastPin&, byte[]) {}
+};
+
+// Bits INDEX up to COUNT - 1 of a chain's bytes into the level of their virtual pins
+template <typename CHAIN, int INDEX, int COUNT>
+struct ShiftUnpackBits
+{
+    static const int VPIN = CHAIN::virtualPin(INDEX / 8, INDEX % 8);
+
+    static SHIFT_CHAIN_INLINE void unpack(const byte bytes[], bool levels[])
+    {
+        levels[VPIN] = (bytes[INDEX / 8] >> (INDEX % 8)) & 1;
+        ShiftUnpackBits<CHAIN, INDEX + 1, COUNT>::unpack(bytes, levels);
+    }
+};
+template <typename CHAIN, int COUNT>
+struct ShiftUnpackBits<CHAIN, COUNT, COUNT>
+{
+    static SHIFT_CHAIN_INLINE void unpack(const byte[], bool[]) {}
+};
+
+#pragma endregion
+
+#pragma region Chains
+
+/// <summary>A 74HC165 chain of BYTE_COUNT registers. Bit b of byte i is virtual pin
+/// FIRST_VPIN + i * 8 + b, or + (7 - b) for boards wired with REVERSED_BITS.</summary>
+template <int BYTE_COUNT, int LOAD_PIN, int CLOCK_PIN, int CLOCK_ENABLE_PIN, int DATA_PIN,
+    int FIRST_VPIN, bool REVERSED_BITS, int SETTLE_NOPS>
+struct ShiftInChain
+{
+    static const int BYTES = BYTE_COUNT;
+    static const int FIRST = FIRST_VPIN;
+    static const int END = FIRST_VPIN + BYTE_COUNT * 8;     // One past the last virtual pin
+
+    static FastPin load, clock, clockEnable, data;
+
+    static void begin()
+    {
+        pinMode(LOAD_PIN, OUTPUT);
+        pinMode(CLOCK_PIN, OUTPUT);
+        pinMode(CLOCK_ENABLE_PIN, OUTPUT);
+        pinMode(DATA_PIN, INPUT);
+        load = fastPin(LOAD_PIN);
+        clock = fastPin(CLOCK_PIN);
+        clockEnable = fastPin(CLOCK_ENABLE_PIN);
+        data = fastPin(DATA_PIN);
+        fastWrite(load, HIGH);
+        fastWrite(clock, LOW);
+        fastWrite(clockEnable, HIGH);
+    }
+
+    /// <summary>Load the chain and read every register. Safe to call from an interrupt.</summary>
+    static SHIFT_CHAIN_INLINE void read(byte bytes[])
+    {
+        // Pulse load
+        fastWrite(load, LOW);
+        delayMicroseconds(SHIFT_IN_LOAD_MICROS);
+        fastWrite(load, HIGH);
+        delayMicroseconds(SHIFT_IN_LOAD_MICROS);
+        // Get data
+        fastWrite(clock, HIGH);
+        fastWrite(clockEnable, LOW);
+        ShiftInBytes<0, BYTE_COUNT, SETTLE_NOPS>::read(clock, data, bytes);
+        fastWrite(clockEnable, HIGH);
+    }
+
+    static constexpr int virtualPin(int byteIndex, int bit)
+    {
+        return FIRST_VPIN + byteIndex * 8 + (REVERSED_BITS ? 7 - bit : bit);
+    }
+};
+
+template <int B, int L, int C, int E, int D, int F, bool R, int N> FastPin ShiftInChain<B, L, C, E, D, F, R, N>::load;
+template <int B, int L, int C, int E, int D, int F, bool R, int N> FastPin ShiftInChain<B, L, C, E, D, F, R, N>::clock;
+template <int B, int L, int C, int E, int D, int F, bool R, int N> FastPin ShiftInChain<B, L, C, E, D, F, R, N>::clockEnable;
+template <int B, int L, int C, int E, int D, int F, bool R, int N> FastPin ShiftInChain<B, L, C, E, D, F, R, N>::data;
+
+/// <summary>A 74HC595 chain of BYTE_COUNT registers driving LEDs FIRST_LED onwards, bit b of byte i
+/// is LED FIRST_LED + i * 8 + b.</summary>
+template <int BYTE_COUNT, int DATA_PIN, int LATCH_PIN, int CLOCK_PIN, int FIRST_LED, int SETTLE_NOPS>
+struct ShiftOutChain
+{
+    static const int BYTES = BYTE_COUNT;
+    static const int FIRST = FIRST_LED;
+    static const int END = FIRST_LED + BYTE_COUNT * 8;      // One past the last LED
+
+    static FastPin data, latch, clock;
+
+    static void begin()
+    {
+        pinMode(DATA_PIN, OUTPUT);
+        pinMode(LATCH_PIN, OUTPUT);
+        pinMode(CLOCK_PIN, OUTPUT);
+        data = fastPin(DATA_PIN);
+        latch = fastPin(LATCH_PIN);
+        clock = fastPin(CLOCK_PIN);
+    }
+
+    /// <summary>Shift every register out and latch them. Safe to call from an interrupt.</summary>
+    static SHIFT_CHAIN_INLINE void send(const byte bytes[])
+    {
+        fastWrite(latch, LOW);
+        ShiftOutBytes<BYTE_COUNT - 1, SETTLE_NOPS>::send(data, clock, bytes);
+        fastWrite(latch, HIGH);
+    }
+};
+
+template <int B, int D, int L, int C, int F, int N> FastPin ShiftOutChain<B, D, L, C, F, N>::data;
+template <int B, int D, int L, int C, int F, int N> FastPin ShiftOutChain<B, D, L, C, F, N>::latch;
+template <int B, int D, int L, int C, int F, int N> FastPin ShiftOutChain<B, D, L, C, F, N>::clock;
+
+#pragma endregion
+
+#pragma region Chain lists
+
+/// <summary>Every input chain on the controller. Their bytes sit back to back in one buffer,
+/// in list order.</summary>
+template <typename... CHAINS>
+struct ShiftInChains;
+
+template <>
+struct ShiftInChains<>
+{
+    static const int BYTES = 0;
+    static const int END = 0;
+
+    static void begin() {}
+    static SHIFT_CHAIN_INLINE void read(byte[]) {}
+    static SHIFT_CHAIN_INLINE void unpack(const byte[], bool[]) {}
+    static constexpr int virtualPin(int, int) { return -1; }
+};
+
+template <typename CHAIN, typename... REST>
+struct ShiftInChains<CHAIN, REST...>
+{
+    typedef ShiftInChains<REST...> Rest;
+    static const int BYTES = CHAIN::BYTES + Rest::BYTES;
+    // One past the highest virtual pin of any chain
+    static const int END = CHAIN::END > Rest::END ? CHAIN::END : Rest::END;
+
+    static void begin()
+    {
+        CHAIN::begin();
+        Rest::begin();
+    }
+
+    static SHIFT_CHAIN_INLINE void read(byte bytes[])
+    {
+        CHAIN::read(bytes);
+        Rest::read(bytes + CHAIN::BYTES);
+    }
+
+    /// <summary>Spread the bytes read into one level per virtual pin, unrolled with the pins fixed.</summary>
+    static SHIFT_CHAIN_INLINE void unpack(const byte bytes[], bool levels[])
+    {
+        ShiftUnpackBits<CHAIN, 0, CHAIN::BYTES * 8>::unpack(bytes, levels);
+        Rest::unpack(bytes + CHAIN::BYTES, levels);
+    }
+
+    /// <summary>Virtual pin of a bit, by its byte in the whole buffer. See ShiftInPinTable for a lookup.</summary>
+    static constexpr int virtualPin(int byteIndex, int bit)
+    {
+        return byteIndex < CHAIN::BYTES ? CHAIN::virtualPin(byteIndex, bit) : Rest::virtualPin(byteIndex - CHAIN::BYTES, bit);
+    }
+};
+
+/// <summary>Every output chain on the controller. Their bytes sit back to back in one buffer,
+/// in list order.</summary>
+template <typename... CHAINS>
+struct ShiftOutChains;
+
+template <>
+struct ShiftOutChains<>
+{
+    static const int BYTES = 0;
+    static const int END = 0;
+
+    static void begin() {}
+    static SHIFT_CHAIN_INLINE void send(const byte[]) {}
+    static constexpr int bitIndex(int) { return -1; }
+};
+
+template <typename CHAIN, typename... REST>
+struct ShiftOutChains<CHAIN, REST...>
+{
+    typedef ShiftOutChains<REST...> Rest;
+    static const int BYTES = CHAIN::BYTES + Rest::BYTES;
+    // One past the highest LED of any chain
+    static const int END = CHAIN::END > Rest::END ? CHAIN::END : Rest::END;
+
+    static void begin()
+    {
+        CHAIN::begin();
+        Rest::begin();
+    }
+
+    static SHIFT_CHAIN_INLINE void send(const byte bytes[])
+    {
+        CHAIN::send(bytes);
+        Rest::send(bytes + CHAIN::BYTES);
+    }
+
+    /// <summary>Bit of an LED in the whole buffer (byte * 8 + bit), -1 if no chain drives it.</summary>
+    static constexpr int bitIndex(int led)
+    {
+        return led >= CHAIN::FIRST && led < CHAIN::END ? led - CHAIN::FIRST
+            : Rest::bitIndex(led) < 0 ? -1 : Rest::bitIndex(led) + CHAIN::BYTES * 8;
+    }
+};
+
+/// <summary>Virtual pin of every bit of an input chain list's buffer (byte * 8 + bit), worked out
+/// by the compiler.</summary>
+template <typename CHAINS, typename BITS = typename MakeShiftIndexList<CHAINS::BYTES * 8>::Type>
+struct ShiftInPinTable;
+
+template <typename CHAINS, int... BITS>
+struct ShiftInPinTable<CHAINS, ShiftIndexList<BITS...> >
+{
+    static constexpr byte VPINS[sizeof...(BITS)] = { CHAINS::virtualPin(BITS / 8, BITS % 8)... };
+};
+
+template <typename CHAINS, int... BITS>
+constexpr byte ShiftInPinTable<CHAINS, ShiftIndexList<BITS...> >::VPINS[sizeof...(BITS)];
+
+#pragma endregion
+
+#endif
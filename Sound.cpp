@@ -0,0 +1,197 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include <Arduino.h>
+#include "Sound.h"
+
+// Tone timer: TC1 channel 0 (TC3 interrupt), clocked from MCK/2
+#define _SOUND_TC TC1
+#define _SOUND_TC_CHANNEL 0
+#define _SOUND_TC_IRQ TC3_IRQn
+#define _SOUND_TC_ID ID_TC3
+// Above the LED refresh interrupt, a bit plane being shifted out must not hold off a sample
+const uint32_t _SOUND_IRQ_PRIORITY = 2;
+
+// Phase accumulator step for 1 Hz: 2^32 / SOUND_SAMPLE_RATE
+const uint32_t _PHASE_PER_HZ = 4294967296ULL / SOUND_SAMPLE_RATE;
+
+struct Voice
+{
+    const int* pattern;     // Frequencies (Hz) to step through, nullptr for a steady tone
+    byte length;
+    byte index;
+    uint32_t stepSamples;   // Samples per pattern step
+    uint32_t sampleCount;   // Samples into the current step
+    uint32_t phase;
+    uint32_t phaseInc;      // 0 = silent
+    bool active;
+};
+
+volatile Voice _voices[SOUND_VOICES];
+
+Pio* _soundPort = nullptr;
+uint32_t _soundMask = 0;
+uint32_t _mixAccumulator = 0;
+bool _timerRunning = false;
+
+uint32_t _phaseIncFor(int frequency)
+{
+    if (frequency <= 0) return 0;
+    if (frequency > SOUND_MAX_FREQUENCY) frequency = SOUND_MAX_FREQUENCY;
+    return _PHASE_PER_HZ * (uint32_t)frequency;
+}
+
+void _startTimer()
+{
+    if (_timerRunning) return;
+    _timerRunning = true;
+    TC_Start(_SOUND_TC, _SOUND_TC_CHANNEL);
+}
+
+void _stopTimerIfIdle()
+{
+    for (int i = 0; i < SOUND_VOICES; i++)
+    {
+        if (_voices[i].active) return;
+    }
+    TC_Stop(_SOUND_TC, _SOUND_TC_CHANNEL);
+    _timerRunning = false;
+    _soundPort->PIO_CODR = _soundMask;
+}
+
+/// <summary>Initialize the tone timer and sound pin.</summary>
+void SoundClass::init(int pin)
+{
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    _soundPort = g_APinDescription[pin].pPort;
+    _soundMask = g_APinDescription[pin].ulPin;
+
+    for (int i = 0; i < SOUND_VOICES; i++)
+    {
+        _voices[i].active = false;
+        _voices[i].pattern = nullptr;
+        _voices[i].phaseInc = 0;
+    }
+
+    pmc_set_writeprotect(false);
+    pmc_enable_periph_clk(_SOUND_TC_ID);
+    TC_Configure(_SOUND_TC, _SOUND_TC_CHANNEL, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK1);
+    TC_SetRC(_SOUND_TC, _SOUND_TC_CHANNEL, VARIANT_MCK / 2 / SOUND_SAMPLE_RATE);
+    _SOUND_TC->TC_CHANNEL[_SOUND_TC_CHANNEL].TC_IER = TC_IER_CPCS;
+    _SOUND_TC->TC_CHANNEL[_SOUND_TC_CHANNEL].TC_IDR = ~TC_IER_CPCS;
+    NVIC_SetPriority(_SOUND_TC_IRQ, _SOUND_IRQ_PRIORITY);
+    NVIC_EnableIRQ(_SOUND_TC_IRQ);
+}
+
+void SoundClass::play(byte voice, const int* pattern, byte length, unsigned int stepMs)
+{
+    if (voice >= SOUND_VOICES || pattern == nullptr || length == 0) return;
+
+    uint32_t stepSamples = (uint32_t)stepMs * SOUND_SAMPLE_RATE / 1000;
+    if (stepSamples == 0) stepSamples = 1;
+
+    volatile Voice& v = _voices[voice];
+    // Already playing this pattern, leave it running
+    if (v.active && v.pattern == pattern && v.length == length && v.stepSamples == stepSamples) return;
+
+    NVIC_DisableIRQ(_SOUND_TC_IRQ);
+    v.pattern = pattern;
+    v.length = length;
+    v.index = 0;
+    v.stepSamples = stepSamples;
+    v.sampleCount = 0;
+    v.phase = 0;
+    v.phaseInc = _phaseIncFor(pattern[0]);
+    v.active = true;
+    NVIC_EnableIRQ(_SOUND_TC_IRQ);
+    _startTimer();
+}
+
+void SoundClass::setTone(byte voice, int frequency)
+{
+    if (voice >= SOUND_VOICES) return;
+    if (frequency <= 0)
+    {
+        stop(voice);
+        return;
+    }
+
+    volatile Voice& v = _voices[voice];
+    NVIC_DisableIRQ(_SOUND_TC_IRQ);
+    v.pattern = nullptr;
+    v.phaseInc = _phaseIncFor(frequency);
+    v.active = true;
+    NVIC_EnableIRQ(_SOUND_TC_IRQ);
+    _startTimer();
+}
+
+void SoundClass::stop(byte voice)
+{
+    if (voice >= SOUND_VOICES || !_voices[voice].active) return;
+
+    NVIC_DisableIRQ(_SOUND_TC_IRQ);
+    _voices[voice].active = false;
+    _voices[voice].pattern = nullptr;
+    NVIC_EnableIRQ(_SOUND_TC_IRQ);
+    _stopTimerIfIdle();
+}
+
+bool SoundClass::isPlaying(byte voice)
+{
+    return voice < SOUND_VOICES && _voices[voice].active;
+}
+
+/// <summary>Step patterns and mix voices. Each voice is a square wave, the mix is
+/// written to the pin with a first order sigma-delta so two tones sound at once.</summary>
+void SoundClass::isr()
+{
+    uint32_t activeCount = 0;
+    uint32_t highCount = 0;
+
+    for (int i = 0; i < SOUND_VOICES; i++)
+    {
+        volatile Voice& v = _voices[i];
+        if (!v.active) continue;
+
+        // Pattern stepping, exact to the sample
+        if (v.pattern != nullptr && ++v.sampleCount >= v.stepSamples)
+        {
+            v.sampleCount = 0;
+            v.index = (v.index + 1 >= v.length) ? 0 : v.index + 1;
+            v.phaseInc = _phaseIncFor(v.pattern[v.index]);
+        }
+        if (v.phaseInc == 0) continue; // Rest step
+
+        activeCount++;
+        v.phase += v.phaseInc;
+        if (v.phase & 0x80000000) highCount++;
+    }
+
+    bool level = false;
+    if (activeCount > 0)
+    {
+        _mixAccumulator += highCount;
+        if (_mixAccumulator >= activeCount)
+        {
+            _mixAccumulator -= activeCount;
+            level = true;
+        }
+    }
+
+    if (level) _soundPort->PIO_SODR = _soundMask;
+    else _soundPort->PIO_CODR = _soundMask;
+}
+
+void TC3_Handler()
+{
+    TC_GetStatus(_SOUND_TC, _SOUND_TC_CHANNEL);
+    Sound.isr();
+}
+
+
+SoundClass Sound;
@@ -0,0 +1,46 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Sound.h
+
+#ifndef _SOUND_h
+#define _SOUND_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+// Number of independent voices mixed onto the sound pin
+#define SOUND_VOICES 2
+// Tone generator interrupt rate (Hz). Voices are stepped and mixed at this rate.
+#define SOUND_SAMPLE_RATE 20000
+// Highest frequency a voice will play (Hz)
+#define SOUND_MAX_FREQUENCY 8000
+
+class SoundClass
+{
+public:
+
+	void init(int pin);
+
+	// Loop a frequency pattern (Hz per step, 0 = rest) on a voice. Calling again with the
+	// same pattern keeps it playing without restarting, so it is safe to call every loop.
+	void play(byte voice, const int* pattern, byte length, unsigned int stepMs);
+	// Play a steady tone on a voice, 0 = silent
+	void setTone(byte voice, int frequency);
+	void stop(byte voice);
+	bool isPlaying(byte voice);
+
+	// Timer interrupt body, do not call directly
+	void isr();
+};
+
+extern SoundClass Sound;
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "Trace.h"
+
+#pragma region Private
+
+// Format string per event, only read when a record is formatted
+#define TRACE_FORMAT_ENTRY(id, format) format,
+const char* const _TRACE_FORMATS[TRACE_EVENT_COUNT] = {
+    TRACE_EVENTS(TRACE_FORMAT_ENTRY)
+};
+#undef TRACE_FORMAT_ENTRY
+
+TraceRecord _records[TRACE_BUFFER_SIZE];
+uint32_t _head = 0;     // Next record to write
+uint32_t _tail = 0;     // Oldest record not drained
+uint32_t _lost = 0;
+
+/// <summary>Append text to a line buffer, cutting it off at the end.</summary>
+int _append(char* buffer, int pos, int size, const char* text)
+{
+    while (*text && pos < size - 1)
+    {
+        buffer[pos++] = *text++;
+    }
+    return pos;
+}
+
+#pragma endregion
+
+
+#pragma region Public
+
+void TraceClass::push(const TraceRecord& record)
+{
+    uint32_t now = micros();
+    noInterrupts();
+    if (_head - _tail >= TRACE_BUFFER_SIZE)
+    {
+        // Full, drop the oldest
+        _tail++;
+        _lost++;
+    }
+    TraceRecord& r = _records[_head % TRACE_BUFFER_SIZE];
+    r = record;
+    r.micros = now;
+    _head++;
+    interrupts();
+}
+
+bool TraceClass::pop(TraceRecord& record)
+{
+    noInterrupts();
+    bool available = _tail != _head;
+    if (available)
+    {
+        record = _records[_tail % TRACE_BUFFER_SIZE];
+        _tail++;
+    }
+    interrupts();
+    return available;
+}
+
+int TraceClass::format(const TraceRecord& record, char* buffer, int size)
+{
+    if (size <= 0) return 0;
+    if (record.id >= TRACE_EVENT_COUNT)
+    {
+        buffer[0] = '\0';
+        return 0;
+    }
+
+    const char* fmt = _TRACE_FORMATS[record.id];
+    int pos = 0;
+    byte arg = 0;
+    char number[16];
+    while (*fmt && pos < size - 1)
+    {
+        if (*fmt != '%' || fmt[1] == '\0')
+        {
+            buffer[pos++] = *fmt++;
+            continue;
+        }
+        char spec = fmt[1];
+        fmt += 2;
+        if (spec == '%')
+        {
+            buffer[pos++] = '%';
+            continue;
+        }
+        if (arg >= record.argCount)
+        {
+            pos = _append(buffer, pos, size, "?");
+            continue;
+        }
+
+        int32_t value = record.args[arg];
+        if (bitRead(record.floatMask, arg))
+        {
+            float f;
+            memcpy(&f, &value, sizeof(f));
+            dtostrf(f, 1, 2, number);
+        }
+        else if (spec == 'x')
+        {
+            ultoa((uint32_t)value, number, 16);
+        }
+        else if (spec == 'b')
+        {
+            strcpy(number, value ? "ON" : "OFF");
+        }
+        else
+        {
+            ltoa(value, number, 10);
+        }
+        pos = _append(buffer, pos, size, number);
+        arg++;
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+void TraceClass::dump(Print& out)
+{
+    TraceRecord record;
+    char line[TRACE_LINE_LENGTH];
+    while (pop(record))
+    {
+        format(record, line, sizeof(line));
+        out.print(record.micros / 1000);
+        out.print(" ms: ");
+        out.println(line);
+    }
+}
+
+void TraceClass::clear()
+{
+    noInterrupts();
+    _tail = _head;
+    interrupts();
+}
+
+int TraceClass::pending()
+{
+    return _head - _tail;
+}
+
+uint32_t TraceClass::lost()
+{
+    return _lost;
+}
+
+#pragma endregion
+
+
+TraceClass Trace;
@@ -0,0 +1,184 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Trace.h
+
+#ifndef _TRACE_h
+#define _TRACE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+// Set to 0 to compile every TRACE() call out, arguments included
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+// Records kept until they are drained, oldest are overwritten when full
+#define TRACE_BUFFER_SIZE 64
+// Arguments per record
+#define TRACE_MAX_ARGS 3
+// Longest formatted line
+#define TRACE_LINE_LENGTH 64
+
+// Trace events: id and format. %d = integer, %x = hex, %f = float (2 decimals), %b = ON/OFF.
+#define TRACE_EVENTS(X) \
+    X(TRACE_IO_INITIALIZED,         "I/O Initialized") \
+    X(TRACE_TESTING_IO,             "Testing I/O") \
+    X(TRACE_IO_TESTED,              "I/O Tested") \
+    X(TRACE_STARTING_SIMPIT,        "Starting Simpit") \
+    X(TRACE_CONNECTED,              "KSP Controller Connected!") \
+    X(TRACE_LINK_DEGRADED,          "Link degraded: %d ms silent") \
+    X(TRACE_LINK_DOWN,              "Link down (%d drops), reconnecting") \
+    X(TRACE_LINK_RECONNECTED,       "Link back after %d ms (%d reconnects)") \
+    X(TRACE_VESSEL_CHANGED,         "Vessel %x, settings cached %b") \
+    X(TRACE_BOOT_TIMES,             "Boot ms: setup %d, IO %d, self-test %d") \
+    X(TRACE_BOOT_TIMES_2,           "Boot ms: Simpit %d, first frame %d") \
+    X(TRACE_INPUT_PRESSED,          "Input %d pressed") \
+    X(TRACE_LOOP_TIME,              "Loop time: %d ms") \
+    X(TRACE_LOOP_RATE,              "Loop rate: %f Hz") \
+    X(TRACE_LED_REFRESH,            "LED refresh: %d Hz, ISR load %d/1000, max ISR %d us") \
+    X(TRACE_INPUT_CAPTURE,          "Input capture: %d edges, %d dropped, max queue %d") \
+    X(TRACE_IDLE,                   "Idle: %d%% asleep (%d ms), entered %d times") \
+    X(TRACE_END_OF_LOOP,            "------------END OF LOOP---------------") \
+    X(TRACE_LF_RAW,                 "LF raw bytes: %x %x") \
+    X(TRACE_LF_PARSED,              "LF parsed: total=%f avail=%f") \
+    X(TRACE_LF_WRONG_SIZE,          "LF wrong size: got %d expected %d") \
+    X(TRACE_OX_RECEIVED,            "OX data received: %f/%f") \
+    X(TRACE_SF_RECEIVED,            "SF data received: %f/%f") \
+    X(TRACE_MP_RECEIVED,            "MP data received: %f/%f") \
+    X(TRACE_EC_RECEIVED,            "EC data received: %f/%f") \
+    X(TRACE_MOD_PRESSED,            "Mod pressed - Right Shift down") \
+    X(TRACE_MOD_RELEASED,           "Mod released - Right Shift up") \
+    X(TRACE_PITCH_WARNING_CANCEL,   "PITCH warning cancel - Numpad 9") \
+    X(TRACE_ALT_WARNING_CANCEL,     "ALT warning cancel - Numpad 8") \
+    X(TRACE_COMMS_WARNING_CANCEL,   "COMMS warning cancel - Numpad 7") \
+    X(TRACE_GEAR_WARNING_CANCEL,    "GEAR warning cancel - Numpad 6") \
+    X(TRACE_RCS_WARNING_CANCEL,     "RCS warning cancel - Numpad 5") \
+    X(TRACE_SAS_WARNING_CANCEL,     "SAS warning cancel - Numpad 4") \
+    X(TRACE_BRAKE_WARNING_CANCEL,   "BRAKE warning cancel - Numpad 3") \
+    X(TRACE_WARP_WARNING_CANCEL,    "WARP warning cancel - Numpad 2") \
+    X(TRACE_GEE_WARNING_CANCEL,     "GEE warning cancel - Numpad 1") \
+    X(TRACE_TEMP_WARNING_CANCEL,    "TEMP warning cancel - Numpad 0") \
+    X(TRACE_STAGE,                  "Stage button pressed") \
+    X(TRACE_ABORT,                  "Abort button pressed") \
+    X(TRACE_LIGHTS,                 "Lights %b") \
+    X(TRACE_GEAR_UP,                "Gear UP") \
+    X(TRACE_GEAR_DOWN,              "Gear DOWN") \
+    X(TRACE_BRAKES,                 "Brakes %b") \
+    X(TRACE_DOCKING_MODE,           "Docking mode %b") \
+    X(TRACE_CAG_TOGGLED,            "CAG%d toggled") \
+    X(TRACE_SAS,                    "SAS %b") \
+    X(TRACE_RCS,                    "RCS %b") \
+    X(TRACE_SAS_MODE,               "SAS mode: %d") \
+    X(TRACE_CAMERA_RESET,           "Camera reset - backtick key") \
+    X(TRACE_CAMERA_MODE,            "Camera mode changed - V key") \
+    X(TRACE_FOCUS_CHANGED,          "Focus changed") \
+    X(TRACE_CAMERA_VIEW,            "Camera view cycled") \
+    X(TRACE_MAP_TOGGLED,            "Map Toggled") \
+    X(TRACE_UI_TOGGLED,             "UI Toggled") \
+    X(TRACE_SOUND_SWITCH,           "Sound switch toggled") \
+    X(TRACE_AUTOPILOT_REFUSED,      "Cannot engage autopilot") \
+    X(TRACE_AUTOPILOT_DISENGAGED,   "Autopilot disengaged") \
+    X(TRACE_AUTOPILOT_OVERRIDE,     "Autopilot cancelled by joystick override (%d)") \
+    X(TRACE_WARP_CANCELLED,         "Warp cancelled") \
+    X(TRACE_WARP_INCREASED,         "Warp increased") \
+    X(TRACE_WARP_DECREASED,         "Warp decreased") \
+    X(TRACE_PAUSE_TOGGLED,          "Pause toggled") \
+    X(TRACE_ROTATION_BUTTON_HOME,   "Rotation button - HOME key") \
+    X(TRACE_ROTATION_BUTTON_SPACE,  "Rotation button - SPACE key") \
+    X(TRACE_EVA_GRAB,               "EVA Grab") \
+    X(TRACE_EVA_BOARD,              "EVA Board") \
+    X(TRACE_PRECISION,              "Precision %d%%") \
+    X(TRACE_VIEW_MODE,              "View mode %b") \
+    X(TRACE_TRANSLATION_TRIM,       "Translation TRIM adjusted") \
+    X(TRACE_TRANSLATION_TRIM_RESET, "Translation TRIM reset") \
+    X(TRACE_ROTATION_TRIM,          "Rotation TRIM adjusted") \
+    X(TRACE_ROTATION_TRIM_RESET,    "Rotation TRIM reset")
+
+#define TRACE_ENUM_ENTRY(id, format) id,
+enum TraceEvent
+{
+    TRACE_EVENTS(TRACE_ENUM_ENTRY)
+    TRACE_EVENT_COUNT
+};
+#undef TRACE_ENUM_ENTRY
+
+// One binary trace record, nothing is formatted until it is drained
+struct TraceRecord
+{
+    uint16_t id;
+    byte argCount;
+    byte floatMask;             // Bit N set if args[N] holds float bits
+    uint32_t micros;
+    int32_t args[TRACE_MAX_ARGS];
+};
+
+class TraceClass
+{
+public:
+
+	// Store an event with up to TRACE_MAX_ARGS integer or float arguments. Safe from interrupts.
+	template <typename... Args> void record(TraceEvent id, Args... args)
+	{
+		static_assert(sizeof...(Args) <= TRACE_MAX_ARGS, "Too many trace arguments");
+		TraceRecord r;
+		r.id = id;
+		r.argCount = sizeof...(Args);
+		r.floatMask = 0;
+		_store(r, 0, args...);
+		push(r);
+	}
+
+	void push(const TraceRecord& record);
+	// Take the oldest record, false if there is none
+	bool pop(TraceRecord& record);
+	// Format a record into text, returns the length
+	int format(const TraceRecord& record, char* buffer, int size);
+	// Format and print every waiting record
+	void dump(Print& out);
+	void clear();
+
+	// Records waiting, and records overwritten before they were drained
+	int pending();
+	uint32_t lost();
+
+private:
+
+	void _store(TraceRecord&, byte) {}
+	template <typename T, typename... Rest> void _store(TraceRecord& r, byte index, T first, Rest... rest)
+	{
+		_storeArg(r, index, first);
+		_store(r, index + 1, rest...);
+	}
+	void _storeArg(TraceRecord& r, byte index, float value)
+	{
+		memcpy(&r.args[index], &value, sizeof(value));
+		bitSet(r.floatMask, index);
+	}
+	void _storeArg(TraceRecord& r, byte index, double value) { _storeArg(r, index, (float)value); }
+	void _storeArg(TraceRecord& r, byte index, int value) { r.args[index] = value; }
+	void _storeArg(TraceRecord& r, byte index, unsigned int value) { r.args[index] = (int32_t)value; }
+	void _storeArg(TraceRecord& r, byte index, long value) { r.args[index] = value; }
+	void _storeArg(TraceRecord& r, byte index, unsigned long value) { r.args[index] = (int32_t)value; }
+	void _storeArg(TraceRecord& r, byte index, byte value) { r.args[index] = value; }
+	void _storeArg(TraceRecord& r, byte index, bool value) { r.args[index] = value; }
+};
+
+extern TraceClass Trace;
+
+#if TRACE_ENABLED
+#define TRACE(...) Trace.record(__VA_ARGS__)
+#else
+// Never runs, but arguments are still type checked and do not leave unused variables behind
+#define TRACE(...) do { if (false) Trace.record(__VA_ARGS__); } while (0)
+#endif
+
+#endif
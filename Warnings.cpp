@@ -0,0 +1,224 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+#include "Warnings.h"
+#include "Sound.h"
+#include "Link.h"
+
+#pragma region Private
+
+// Evaluation state per rule
+struct _RuleState
+{
+    bool active;
+    bool pending;               // Condition met (or cleared), waiting out the hold time
+    unsigned long since;        // millis() the pending or active state began
+};
+
+const byte _NO_RULE = 255;
+const byte _UNKNOWN_RULE = 254;     // Output state not known yet, the next arbitration writes it
+
+const WarningRule* _rules = nullptr;
+byte _ruleCount = 0;
+_RuleState _states[MAX_WARNING_RULES];
+uint64_t _allChannels = 0;                  // Union of every rule's channels
+uint32_t _seenSeq[LINK_CHANNEL_COUNT];      // Link::channelSeq() at the last evaluation
+byte _ledOwner[MAX_WARNING_RULES];          // Rule shown on each rule's LED, by the first rule using that LED
+byte _voiceOwner[SOUND_VOICES];             // Rule playing on each voice
+bool _dirty = true;                         // Something changed, run the arbiter
+
+/// <summary>Channels that have received a frame since the last call.</summary>
+uint64_t _updatedChannels()
+{
+    uint64_t updated = 0;
+    for (byte type = 0; type < LINK_CHANNEL_COUNT; type++)
+    {
+        if (!(_allChannels & WARNING_CHANNEL(type)))
+            continue;
+        uint32_t seq = Link.channelSeq(type);
+        if (seq != _seenSeq[type])
+        {
+            _seenSeq[type] = seq;
+            updated |= WARNING_CHANNEL(type);
+        }
+    }
+    return updated;
+}
+
+/// <summary>Step one rule, with hysteresis on the value and the hold time on both edges.</summary>
+void _evaluate(byte i, unsigned long now)
+{
+    const WarningRule& rule = _rules[i];
+    _RuleState& state = _states[i];
+
+    fix16_t value = rule.read();
+    bool high = rule.offThreshold <= rule.onThreshold;
+    bool wanted = state.active
+        ? (high ? value >= rule.offThreshold : value <= rule.offThreshold)     // Stays on until past the off threshold
+        : (high ? value >= rule.onThreshold : value <= rule.onThreshold);
+
+    if (wanted == state.active)
+    {
+        state.pending = false;
+        return;
+    }
+    if (!state.pending)
+    {
+        state.pending = true;
+        state.since = now;
+    }
+    if (now - state.since >= rule.holdMs)
+    {
+        state.active = wanted;
+        state.pending = false;
+        state.since = now;
+        _dirty = true;
+    }
+}
+
+/// <summary>Give each LED and voice to the highest priority active rule.</summary>
+void _arbitrate()
+{
+    // LEDs: the first rule using an LED drives it for every rule on that LED
+    for (byte i = 0; i < _ruleCount; i++)
+    {
+        byte led = _rules[i].led;
+        if (led == WARNING_NO_LED)
+            continue;
+        bool isFirst = true;
+        for (byte j = 0; j < i && isFirst; j++)
+        {
+            if (_rules[j].led == led) isFirst = false;
+        }
+        if (!isFirst)
+            continue;
+
+        byte owner = _NO_RULE;
+        for (byte j = i; j < _ruleCount; j++)
+        {
+            if (_rules[j].led != led || !_states[j].active)
+                continue;
+            if (owner == _NO_RULE || _rules[j].priority > _rules[owner].priority)
+                owner = j;
+        }
+        if (owner == _ledOwner[i])
+            continue;
+        _ledOwner[i] = owner;
+        if (owner == _NO_RULE)
+            Output.setLED(led, false);
+        else
+            Output.setLEDPattern(led, _rules[owner].pattern, _rules[owner].periodMs);
+    }
+
+    // Voices: the highest priority sounds, one per voice
+    byte taken[SOUND_VOICES];
+    for (byte voice = 0; voice < SOUND_VOICES; voice++)
+    {
+        byte owner = _NO_RULE;
+        for (byte j = 0; j < _ruleCount; j++)
+        {
+            if (_rules[j].sound == nullptr || !_states[j].active)
+                continue;
+            bool isTaken = false;
+            for (byte v = 0; v < voice; v++)
+            {
+                if (taken[v] == j) isTaken = true;
+            }
+            if (isTaken)
+                continue;
+            if (owner == _NO_RULE || _rules[j].priority > _rules[owner].priority)
+                owner = j;
+        }
+        taken[voice] = owner;
+        if (owner == _voiceOwner[voice])
+            continue;
+        _voiceOwner[voice] = owner;
+        if (owner == _NO_RULE)
+            Sound.stop(voice);
+        else
+            Sound.play(voice, _rules[owner].sound, _rules[owner].soundLength, _rules[owner].soundStepMs);
+    }
+}
+
+#pragma endregion
+
+
+#pragma region Public
+
+void WarningsClass::init(const WarningRule* rules, byte count)
+{
+    _rules = rules;
+    _ruleCount = min(count, (byte)MAX_WARNING_RULES);
+    _allChannels = 0;
+    for (byte i = 0; i < _ruleCount; i++)
+    {
+        _allChannels |= _rules[i].channels;
+        _states[i].active = false;
+        _states[i].pending = false;
+        _ledOwner[i] = _UNKNOWN_RULE;
+    }
+    for (byte voice = 0; voice < SOUND_VOICES; voice++)
+    {
+        _voiceOwner[voice] = _UNKNOWN_RULE;
+    }
+    _dirty = true;
+}
+
+void WarningsClass::update()
+{
+    unsigned long now = millis();
+    uint64_t updated = _updatedChannels();
+    for (byte i = 0; i < _ruleCount; i++)
+    {
+        if ((_rules[i].channels & updated) || _states[i].pending)
+            _evaluate(i, now);
+    }
+
+    if (_dirty)
+    {
+        _arbitrate();
+        _dirty = false;
+    }
+}
+
+void WarningsClass::clear()
+{
+    for (byte i = 0; i < _ruleCount; i++)
+    {
+        _states[i].active = false;
+        _states[i].pending = false;
+    }
+    _arbitrate();
+    // Evaluate everything again on the next update
+    for (byte type = 0; type < LINK_CHANNEL_COUNT; type++)
+    {
+        _seenSeq[type] = 0;
+    }
+}
+
+void WarningsClass::refresh()
+{
+    for (byte i = 0; i < _ruleCount; i++)
+    {
+        _ledOwner[i] = _UNKNOWN_RULE;
+    }
+    for (byte voice = 0; voice < SOUND_VOICES; voice++)
+    {
+        _voiceOwner[voice] = _UNKNOWN_RULE;
+    }
+    _dirty = true;
+}
+
+bool WarningsClass::isActive(byte rule)
+{
+    return rule < _ruleCount && _states[rule].active;
+}
+
+#pragma endregion
+
+
+WarningsClass Warnings;
@@ -0,0 +1,65 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Warnings.h
+// Table driven warning lights and sounds. Each rule watches one value with separate on and off
+// thresholds, and one arbiter decides which rule gets each LED and sound voice.
+
+#ifndef _WARNINGS_h
+#define _WARNINGS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+#include "FixedPoint.h"
+#include "Output.h"
+#include "Link.h"
+
+#define MAX_WARNING_RULES 16
+// Rule without an LED (e.g. one only shown on an LCD)
+#define WARNING_NO_LED 255
+// Bit for a Simpit message type in WarningRule::channels
+#define WARNING_CHANNEL(messageType) LINK_CHANNEL(messageType)
+
+struct WarningRule
+{
+    uint64_t channels;          // Message types the value is read from, the rule is evaluated when one updates
+    fix16_t (*read)();          // Current value
+    fix16_t onThreshold;        // Switches on at or past this value
+    fix16_t offThreshold;       // Switches off once back past this value. Below onThreshold for a high
+                                // warning (value >= on), above it for a low warning (value <= on).
+    uint16_t holdMs;            // A change of the condition has to last this long before the warning follows it
+    byte led;                   // WARNING_NO_LED for none
+    LEDPattern pattern;
+    uint16_t periodMs;          // LED pattern period
+    const int* sound;           // Sound pattern, nullptr for none
+    byte soundLength;
+    uint16_t soundStepMs;
+    byte priority;              // Highest active rule wins an LED or a voice
+};
+
+class WarningsClass
+{
+public:
+
+	void init(const WarningRule* rules, byte count);
+	// Evaluate every rule whose channels have updated or that is waiting out its hold time,
+	// then drive the LEDs and sound voices
+	void update();
+	// Turn every warning off and release its LEDs and voices (e.g. on leaving flight)
+	void clear();
+	// Write every warning LED and voice again on the next update, e.g. after something else has used them
+	void refresh();
+	bool isActive(byte rule);
+};
+
+extern WarningsClass Warnings;
+
+#endif
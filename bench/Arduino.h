@@ -0,0 +1,21 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// Arduino.h
+// Just enough of the Arduino core for FixedPoint.h and NavMath.cpp to build on a PC,
+// see fixedpoint_bench.cpp. Not part of the sketch.
+
+#ifndef _BENCH_ARDUINO_h
+#define _BENCH_ARDUINO_h
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ Name:		Kerbal_Controller_Arduino rev3.0
+ Created:	4/19/2023 4:14:14 PM
+ Author:	Jacob Cargen
+ Copyright: Jacob Cargen
+*/
+
+// fixedpoint_bench.cpp
+// Host benchmark for FixedPoint.h and NavMath.cpp against the float code they replaced.
+// Accuracy is exact to the firmware, the fixed-point code is the same source. Timings are only
+// a rough guide: a PC has an FPU, so float is far cheaper here than on the SAM3X where every
+// float operation is a library call. Use the console prof command for timings on the Due.
+//
+// Build and run from the sketch folder:
+//   g++ -std=gnu++11 -O2 -Wall -Wno-unknown-pragmas -DARDUINO=100 -Ibench -I. bench/fixedpoint_bench.cpp NavMath.cpp -o fixedpoint_bench
+//   ./fixedpoint_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "FixedPoint.h"
+#include "NavMath.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define BENCH_HAS_TSC 1
+#endif
+
+#pragma region Float reference
+
+// The float code from before the fixed-point change
+
+float shortestAngleDiff(float target, float current)
+{
+    float d = target - current;
+    while (d > 180.0f) d -= 360.0f;
+    while (d <= -180.0f) d += 360.0f;
+    return d;
+}
+
+float horizontalSpeed(float surfaceSpeed, float vertSpeed)
+{
+    return sqrtf(fmaxf(0.0f, surfaceSpeed * surfaceSpeed - vertSpeed * vertSpeed));
+}
+
+float smoothThrottle(float last, float target, float alpha)
+{
+    return last * (1.0f - alpha) + target * alpha;
+}
+
+#pragma endregion
+
+
+#pragma region Harness
+
+const int SAMPLES = 4096;
+const int TIMING_ROUNDS = 2000;
+const double DEGREES_PER_RADIAN = 57.29577951308232;
+
+float inA[SAMPLES], inB[SAMPLES], inT[SAMPLES];
+fix16_t fixA[SAMPLES], fixB[SAMPLES], fixT[SAMPLES];
+volatile int32_t sinkFix;
+volatile float sinkFloat;
+
+/// <summary>Uniform random value in [low, high).</summary>
+float randomIn(float low, float high)
+{
+    return low + (high - low) * (float)rand() / ((float)RAND_MAX + 1.0f);
+}
+
+/// <summary>Fill the inputs with random values, as floats and as their Q16.16 conversion.</summary>
+void fillInputs(float lowA, float highA, float lowB, float highB)
+{
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        inA[i] = randomIn(lowA, highA);
+        inB[i] = randomIn(lowB, highB);
+        inT[i] = randomIn(0.0f, 1.0f);
+        fixA[i] = fix16_from_float_bits(inA[i]);
+        fixB[i] = fix16_from_float_bits(inB[i]);
+        fixT[i] = fix16_from_float_bits(inT[i]);
+    }
+}
+
+/// <summary>Largest error of a run, in the units of the result.</summary>
+struct ErrorStats
+{
+    double maxError;
+    double sumError;
+    int count;
+
+    ErrorStats() : maxError(0), sumError(0), count(0) {}
+    void add(double expected, double actual)
+    {
+        double error = fabs(expected - actual);
+        if (error > maxError) maxError = error;
+        sumError += error;
+        count++;
+    }
+    double meanError() const { return count ? sumError / count : 0; }
+};
+
+/// <summary>Time per call, and TSC cycles per call where the host has a TSC.</summary>
+struct Timing
+{
+    double nanos;
+    double cycles;
+};
+
+template <typename F> Timing timeIt(F body)
+{
+    Timing timing;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+#ifdef BENCH_HAS_TSC
+    uint64_t startCycles = __rdtsc();
+#endif
+    for (int round = 0; round < TIMING_ROUNDS; round++)
+    {
+        for (int i = 0; i < SAMPLES; i++) body(i);
+    }
+#ifdef BENCH_HAS_TSC
+    timing.cycles = (double)(__rdtsc() - startCycles) / ((double)TIMING_ROUNDS * SAMPLES);
+#else
+    timing.cycles = 0;
+#endif
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+    timing.nanos = elapsed.count() / ((double)TIMING_ROUNDS * SAMPLES);
+    return timing;
+}
+
+void printHeader()
+{
+    printf("%-24s %12s %12s %10s %10s %10s %10s\n", "", "max error", "mean error", "fix ns", "float ns", "fix cyc", "float cyc");
+}
+
+void printRow(const char* name, const ErrorStats& error, const Timing& fix, const Timing& flt)
+{
+    printf("%-24s %12.6f %12.6f %10.2f %10.2f %10.1f %10.1f\n", name, error.maxError, error.meanError(),
+        fix.nanos, flt.nanos, fix.cycles, flt.cycles);
+}
+
+#pragma endregion
+
+
+#pragma region Benchmarks
+
+void benchArithmetic()
+{
+    fillInputs(-100.0f, 100.0f, -100.0f, 100.0f);
+    ErrorStats mulError, divError, lerpError;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        mulError.add(inA[i] * inB[i], fix16_to_float(fix16_mul(fixA[i], fixB[i])));
+        if (fabsf(inB[i]) > 1.0f)
+            divError.add(inA[i] / inB[i], fix16_to_float(fix16_div(fixA[i], fixB[i])));
+        lerpError.add(smoothThrottle(inA[i], inB[i], inT[i]), fix16_to_float(fix16_lerp(fixA[i], fixB[i], fixT[i])));
+    }
+    printRow("mul", mulError,
+        timeIt([](int i) { sinkFix = fix16_mul(fixA[i], fixB[i]); }),
+        timeIt([](int i) { sinkFloat = inA[i] * inB[i]; }));
+    printRow("div (|b| > 1)", divError,
+        timeIt([](int i) { sinkFix = fix16_div(fixA[i], fixB[i]); }),
+        timeIt([](int i) { sinkFloat = inA[i] / inB[i]; }));
+    printRow("throttle smoothing", lerpError,
+        timeIt([](int i) { sinkFix = fix16_lerp(fixA[i], fixB[i], fixT[i]); }),
+        timeIt([](int i) { sinkFloat = smoothThrottle(inA[i], inB[i], inT[i]); }));
+}
+
+void benchSquareRoots()
+{
+    fillInputs(0.0f, 2500.0f, -400.0f, 400.0f);
+    ErrorStats sqrtError, horizontalError;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        sqrtError.add(sqrtf(inA[i]), fix16_to_float(fix16_sqrt(fixA[i])));
+        horizontalError.add(horizontalSpeed(inA[i], inB[i]), fix16_to_float(fix16_sqrt_diff_squares(fixA[i], fixB[i])));
+    }
+    printRow("sqrt", sqrtError,
+        timeIt([](int i) { sinkFix = fix16_sqrt(fixA[i]); }),
+        timeIt([](int i) { sinkFloat = sqrtf(inA[i]); }));
+    printRow("horizontal speed", horizontalError,
+        timeIt([](int i) { sinkFix = fix16_sqrt_diff_squares(fixA[i], fixB[i]); }),
+        timeIt([](int i) { sinkFloat = horizontalSpeed(inA[i], inB[i]); }));
+}
+
+void benchAngles()
+{
+    fillInputs(0.0f, 360.0f, 0.0f, 360.0f);
+    ErrorStats wrapError, sinError, atanError;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        wrapError.add(shortestAngleDiff(inA[i], inB[i]), fix16_to_float(fix16_wrap180(fix16_sub(fixA[i], fixB[i]))));
+        sinError.add(sinf(inA[i] / DEGREES_PER_RADIAN), fix16_to_float(navSin(fixA[i])));
+        float y = inA[i] - 180.0f, x = inB[i] - 180.0f;
+        atanError.add(atan2f(y, x) * DEGREES_PER_RADIAN, fix16_to_float(navAtan2(fix16_from_float_bits(y), fix16_from_float_bits(x))));
+    }
+    printRow("shortest angle diff", wrapError,
+        timeIt([](int i) { sinkFix = fix16_wrap180(fix16_sub(fixA[i], fixB[i])); }),
+        timeIt([](int i) { sinkFloat = shortestAngleDiff(inA[i], inB[i]); }));
+    printRow("sin (degrees)", sinError,
+        timeIt([](int i) { sinkFix = navSin(fixA[i]); }),
+        timeIt([](int i) { sinkFloat = sinf(inA[i] / DEGREES_PER_RADIAN); }));
+    printRow("atan2 (degrees)", atanError,
+        timeIt([](int i) { sinkFix = navAtan2(fixA[i] - F16(180), fixB[i] - F16(180)); }),
+        timeIt([](int i) { sinkFloat = atan2f(inA[i] - 180.0f, inB[i] - 180.0f) * DEGREES_PER_RADIAN; }));
+}
+
+void benchConversions()
+{
+    fillInputs(-30000.0f, 30000.0f, -2.0e9f, 2.0e9f);
+    ErrorStats fixError, intError;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        fixError.add(inA[i], fix16_to_float(fixA[i]));
+        intError.add((double)(int32_t)inB[i], (double)int_from_float_bits(inB[i]));
+    }
+    printRow("float to Q16.16", fixError,
+        timeIt([](int i) { sinkFix = fix16_from_float_bits(inA[i]); }),
+        timeIt([](int i) { sinkFloat = inA[i] * 65536.0f; }));
+    printRow("float to int", intError,
+        timeIt([](int i) { sinkFix = int_from_float_bits(inB[i]); }),
+        timeIt([](int i) { sinkFix = (int32_t)inB[i]; }));
+}
+
+/// <summary>Whole degree heading and pitch through vec3FromHeadingPitch and back, the path the
+/// direction LCD takes for the orbital modes.</summary>
+void benchDirectionRoundTrip()
+{
+    ErrorStats headingError, pitchError;
+    int wrongWhole = 0;
+    for (int heading = 0; heading < 360; heading++)
+    {
+        for (int pitch = -89; pitch <= 89; pitch++)
+        {
+            fix16_t h, p;
+            vec3ToHeadingPitch(vec3FromHeadingPitch(fix16_from_int(heading), fix16_from_int(pitch)), h, p);
+            double headingDiff = fix16_to_float(fix16_wrap180(fix16_sub(h, fix16_from_int(heading))));
+            headingError.add(0, headingDiff);
+            pitchError.add(pitch, fix16_to_float(p));
+            if (fix16_round(fix16_wrap360(h)) % 360 != heading || fix16_round(p) != pitch)
+                wrongWhole++;
+        }
+    }
+    printf("%-24s %12.6f %12.6f\n", "heading round trip", headingError.maxError, headingError.meanError());
+    printf("%-24s %12.6f %12.6f\n", "pitch round trip", pitchError.maxError, pitchError.meanError());
+    printf("%-24s %12d of %d shown wrong after rounding\n", "", wrongWhole, headingError.count);
+}
+
+#pragma endregion
+
+
+int main()
+{
+    srand(1);
+    printHeader();
+    benchArithmetic();
+    benchSquareRoots();
+    benchAngles();
+    benchConversions();
+    benchDirectionRoundTrip();
+    return 0;
+}